@@ -2,6 +2,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <sstream>
 #include <stdexcept>
 #include <boost/algorithm/string.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -27,46 +29,195 @@ namespace
         {
             return Model::ChromosomeType::TimeSeries;
         }
+        else if (str == "Geometric Semantic")
+        {
+            return Model::ChromosomeType::GeometricSemantic;
+        }
 
         throw std::invalid_argument(str + " is not a valid Chromosome Type.");
     }
+
+    Model::InitialisationMethod InitialisationMethodFromString(const std::string& str)
+    {
+        if (str == "Grow")
+        {
+            return Model::InitialisationMethod::Grow;
+        }
+        else if (str == "Full")
+        {
+            return Model::InitialisationMethod::Full;
+        }
+        else if (str == "Ramped")
+        {
+            return Model::InitialisationMethod::Ramped;
+        }
+
+        throw std::invalid_argument(str + " is not a valid initialisation method.");
+    }
+
+    Model::MigrationTopology MigrationTopologyFromString(const std::string& str)
+    {
+        if (str == "Ring")
+        {
+            return Model::MigrationTopology::Ring;
+        }
+        else if (str == "Random")
+        {
+            return Model::MigrationTopology::Random;
+        }
+        else if (str == "Fully Connected")
+        {
+            return Model::MigrationTopology::FullyConnected;
+        }
+
+        throw std::invalid_argument(str + " is not a valid migration topology.");
+    }
+
+    Model::SweptParameter SweptParameterFromString(const std::string& str)
+    {
+        static const std::map<std::string, Model::SweptParameter> parameters = {
+            { "PopulationSize", Model::SweptParameter::PopulationSize },
+            { "TwinsPerMatingPair", Model::SweptParameter::TwinsPerMatingPair },
+            { "CarryOverProportion", Model::SweptParameter::CarryOverProportion },
+            { "ParsimonyCoefficient", Model::SweptParameter::ParsimonyCoefficient },
+            { "CrossoverProb", Model::SweptParameter::CrossoverProb },
+            { "MutationProb", Model::SweptParameter::MutationProb },
+            { "HoistMutationProb", Model::SweptParameter::HoistMutationProb },
+            { "TarpeianRate", Model::SweptParameter::TarpeianRate }
+        };
+        auto parameter = parameters.find(str);
+        if (parameter != parameters.end())
+        {
+            return parameter->second;
+        }
+
+        throw std::invalid_argument(str + " is not a parameter that can be swept.");
+    }
+
+    std::string AsString(Model::MigrationTopology topology)
+    {
+        switch (topology)
+        {
+        case Model::MigrationTopology::Random:
+            return "Random";
+        case Model::MigrationTopology::FullyConnected:
+            return "Fully Connected";
+        case Model::MigrationTopology::Ring:
+        default:
+            return "Ring";
+        }
+    }
+
+    std::string AsString(Model::InitialisationMethod method)
+    {
+        switch (method)
+        {
+        case Model::InitialisationMethod::Full:
+            return "Full";
+        case Model::InitialisationMethod::Ramped:
+            return "Ramped";
+        case Model::InitialisationMethod::Grow:
+        default:
+            return "Grow";
+        }
+    }
+
+    /**
+     * Loads the hyperparameters to sweep, if any
+     * @param tree The whole config
+     * @throws std::exception if a swept parameter is unknown or has no values
+     */
+    Model::SweepSpec LoadSweep(const boost::property_tree::ptree& tree)
+    {
+        Model::SweepSpec spec;
+        auto sweep = tree.get_child_optional("Config.Sweep");
+        if (!sweep)
+        {
+            return spec;
+        }
+
+        spec.Random = sweep->get("<xmlattr>.search", std::string("Grid")) == "Random";
+        spec.Samples = sweep->get("<xmlattr>.samples", 10);
+        for (const auto& child : *sweep)
+        {
+            if (child.first == "Parameter")
+            {
+                Model::SweepSpec::Axis axis;
+                axis.Name = child.second.get<std::string>("<xmlattr>.name");
+                axis.Parameter = SweptParameterFromString(axis.Name);
+                std::istringstream values(child.second.data());
+                for (std::string value; values >> value; )
+                {
+                    axis.Values.push_back(boost::lexical_cast<double>(value));
+                }
+                if (axis.Values.empty())
+                {
+                    throw std::invalid_argument("No values to sweep for " + axis.Name);
+                }
+                spec.Axes.push_back(std::move(axis));
+            }
+        }
+        return spec;
+    }
 }
 
 namespace Model
 {
-    Config ConfigParser::s_config{};
-
     Config ConfigParser::Load(const std::string& filename)
     {
+        Config config;
+        boost::property_tree::ptree tree;
         try
         {
             namespace pt = boost::property_tree;
 
-            pt::ptree tree;
             pt::read_xml(filename, tree);
-            s_config.Params.Type = ProgramTypeFromString(tree.get("Config.ProgramType", "Normal"));
-            s_config.Iterations = tree.get("Config.Iterations", 1);
-            s_config.NumGenerations = tree.get("Config.Generations", 20);
-            s_config.StoppingCriteria = tree.get("Config.StoppingCriteria", 0.0);
-            s_config.Params.PopulationSize = tree.get("Config.Population.Size", 1000);
-            s_config.Params.CrossoverProb = tree.get<double>("Config.CrossoverProb", 0.7);
-            s_config.Params.MutationProb = tree.get<double>("Config.MutationProb", 0.01);
-            s_config.Params.HoistMutationProb = tree.get<double>("Config.HoistMutationProb", 0.01);
-            s_config.Params.MinInitialTreeSize = tree.get("Config.Population.MinInitTreeSize", 10);
-
-            s_config.Params.TwinsPerMatingPair = tree.get("Config.Population.TwinsPerMatingPair", 1);
-            s_config.Params.CarryOverProportion = tree.get("Config.Population.CarryOverProportion", 0.0);
+            config.Params.Type = ProgramTypeFromString(tree.get("Config.ProgramType", "Normal"));
+            config.Iterations = tree.get("Config.Iterations", 1);
+            config.NumGenerations = tree.get("Config.Generations", 20);
+            config.StoppingCriteria = tree.get("Config.StoppingCriteria", 0.0);
+            config.Params.PopulationSize = tree.get("Config.Population.Size", 1000);
+            config.Params.CrossoverProb = tree.get<double>("Config.CrossoverProb", 0.7);
+            config.Params.MutationProb = tree.get<double>("Config.MutationProb", 0.01);
+            config.Params.HoistMutationProb = tree.get<double>("Config.HoistMutationProb", 0.01);
+            config.Params.MinInitialTreeSize = tree.get("Config.Population.MinInitTreeSize", 10);
+            config.Params.Initialisation = InitialisationMethodFromString(tree.get("Config.Population.Initialisation", "Grow"));
+
+            config.Params.TwinsPerMatingPair = tree.get("Config.Population.TwinsPerMatingPair", 1);
+            config.Params.CarryOverProportion = tree.get("Config.Population.CarryOverProportion", 0.0);
+            config.Params.IntervalAnalysis = tree.get("Config.Population.IntervalAnalysis", true);
+            config.Params.LinearScaling = tree.get("Config.Population.LinearScaling", false);
+            config.Params.EphemeralConstants = tree.get("Config.Population.EphemeralConstants", false);
+            config.Params.TunedElites = tree.get("Config.Population.TunedElites", 0);
+            config.Params.MaxTreeDepth = tree.get("Config.Population.MaxTreeDepth", 0);
+            config.Params.MaxTreeSize = tree.get("Config.Population.MaxTreeSize", 0);
+            config.Params.BloatRetries = tree.get("Config.Population.BloatRetries", 3);
+            config.Params.TarpeianRate = tree.get("Config.Population.TarpeianRate", 0.0);
+            config.Params.Threads = tree.get("Config.Threads", 0);
+            config.Params.CostParsimony = tree.get("Config.Population.CostParsimony", false);
+            config.Params.GeometricMutationStep = tree.get("Config.ProgramType.<xmlattr>.step", 0.1);
+            config.Params.AdaptiveOperators = tree.get("Config.AdaptiveOperators", false);
+            config.Params.MinOperatorProb = tree.get("Config.AdaptiveOperators.<xmlattr>.min", 0.01);
+            config.Params.MaxOperatorProb = tree.get("Config.AdaptiveOperators.<xmlattr>.max", 0.9);
+            config.Params.OperatorAdaptationRate = tree.get("Config.AdaptiveOperators.<xmlattr>.rate", 0.3);
+            config.Params.SteadyState = tree.get("Config.Population.SteadyState", false);
+            config.Params.ReplaceWorst = tree.get("Config.Population.SteadyState.<xmlattr>.replace", std::string("Tournament")) == "Worst";
+            config.Params.PipelineLag = tree.get("Config.Population.PipelineLag", 0.0);
+            config.Params.Islands = tree.get("Config.Population.Islands", 1);
+            config.Params.MigrationInterval = tree.get("Config.Population.Islands.<xmlattr>.interval", 10);
+            config.Params.Migrants = tree.get("Config.Population.Islands.<xmlattr>.migrants", 2);
+            config.Params.Topology = MigrationTopologyFromString(tree.get("Config.Population.Islands.<xmlattr>.topology", "Ring"));
 
             auto parsimony = tree.get_optional<double>("Config.Population.ParsimonyCoefficient");
             if (parsimony)
             {
-                s_config.Params.ParsimonyCoefficient = *parsimony;
+                config.Params.ParsimonyCoefficient = *parsimony;
             }
             
             auto optSeed = tree.get_optional<int>("Config.Seed");
             if (optSeed)
             {
-                s_config.Params.Seed = *optSeed;
+                config.Params.Seed = *optSeed;
             }
 
             for (const auto& child : tree.get_child("Config.AllowedFunctions"))
@@ -74,15 +225,27 @@ namespace Model
                 if (child.first == "Function")
                 {
                     auto func = FunctionFactory::AsFunctionType(child.second.data());
-                    s_config.Params.AllowedFunctions.push_back(func);
+                    config.Params.AllowedFunctions.push_back(func);
+                }
+            }
+
+            if (auto costs = tree.get_child_optional("Config.Population.PrimitiveCosts"))
+            {
+                for (const auto& child : *costs)
+                {
+                    if (child.first == "Cost")
+                    {
+                        auto func = FunctionFactory::AsFunctionType(child.second.get<std::string>("<xmlattr>.function"));
+                        config.Params.PrimitiveCosts[func] = child.second.get_value<double>();
+                    }
                 }
             }
 
             auto fitnessCasesFile = tree.get("Config.FitnessCases.<xmlattr>.file", std::string("pythagorean_theorem.csv"));
-            int numberOfTerminals = LoadFitnessCases(fitnessCasesFile);
-            s_config.Params.NumberOfTerminals = (s_config.Params.Type == ChromosomeType::TimeSeries) ?
+            int numberOfTerminals = LoadFitnessCases(fitnessCasesFile, config.FitnessCases);
+            config.Params.NumberOfTerminals = (config.Params.Type == ChromosomeType::TimeSeries) ?
                 tree.get("Config.ProgramType.<xmlattr>.lag", 1) : numberOfTerminals;
-            s_config.ForecastSteps = tree.get("Config.ProgramType.<xmlattr>.forecast", 0);
+            config.ForecastSteps = tree.get("Config.ProgramType.<xmlattr>.forecast", 0);
 
             std::cout << "Configuration loaded." << std::endl;
             std::cout << "Fitness cases from " << fitnessCasesFile << std::endl;
@@ -93,40 +256,103 @@ namespace Model
             std::cout << "Continuing with default values...\n" << std::endl;
         }
 
-        PrintConfig();
-        return s_config;
+        // a sweep is only of use with the config it varies, so its errors aren't recoverable with defaults
+        try
+        {
+            config.Sweep = LoadSweep(tree);
+        }
+        catch (std::exception& e)
+        {
+            throw std::invalid_argument("Invalid sweep in " + filename + ": " + e.what());
+        }
+
+        PrintConfig(config);
+        return config;
     }
 
-    void ConfigParser::PrintConfig()
+    void ConfigParser::PrintConfig(const Config& config)
     {
-        std::cout << "\tIterations: " << s_config.Iterations << std::endl;
-        std::cout << "\tGenerations: " << s_config.NumGenerations << std::endl;
-        std::cout << "\tStopping criteria: " << s_config.StoppingCriteria << std::endl;
-        std::cout << "\tPopulation size: " << s_config.Params.PopulationSize << std::endl;
-        std::cout << "\tMinimum initial S-expressions size: " << s_config.Params.MinInitialTreeSize << std::endl;
-        std::cout << "\tCrossover probability: " << s_config.Params.CrossoverProb << std::endl;
-        std::cout << "\tMutation probability: " << s_config.Params.MutationProb << std::endl;
-        std::cout << "\tHoistMutation probability: " << s_config.Params.HoistMutationProb << std::endl;
-        std::cout << "\tNumber of terminals: " << s_config.Params.NumberOfTerminals << std::endl;
-        std::cout << "\tChildren per mating pair: " << s_config.Params.TwinsPerMatingPair*2 << std::endl;
-        std::cout << "\tProportion of population cloned per generation: " << s_config.Params.CarryOverProportion << std::endl;
+        std::cout << "\tIterations: " << config.Iterations << std::endl;
+        std::cout << "\tGenerations: " << config.NumGenerations << std::endl;
+        std::cout << "\tStopping criteria: " << config.StoppingCriteria << std::endl;
+        std::cout << "\tPopulation size: " << config.Params.PopulationSize << std::endl;
+        std::cout << "\tMinimum initial S-expressions size: " << config.Params.MinInitialTreeSize << std::endl;
+        std::cout << "\tInitialisation method: " << AsString(config.Params.Initialisation) << std::endl;
+        std::cout << "\tCrossover probability: " << config.Params.CrossoverProb << std::endl;
+        std::cout << "\tMutation probability: " << config.Params.MutationProb << std::endl;
+        std::cout << "\tHoistMutation probability: " << config.Params.HoistMutationProb << std::endl;
+        std::cout << "\tAdaptive operator probabilities: ";
+        if (config.Params.AdaptiveOperators)
+        {
+            std::cout << "on, within [" << config.Params.MinOperatorProb << ", " << config.Params.MaxOperatorProb 
+                << "] at rate " << config.Params.OperatorAdaptationRate << std::endl;
+        }
+        else
+        {
+            std::cout << "off" << std::endl;
+        }
+        std::cout << "\tNumber of terminals: " << config.Params.NumberOfTerminals << std::endl;
+        std::cout << "\tChildren per mating pair: " << config.Params.TwinsPerMatingPair*2 << std::endl;
+        std::cout << "\tProportion of population cloned per generation: " << config.Params.CarryOverProportion << std::endl;
+        std::cout << "\tInterval analysis: " << (config.Params.IntervalAnalysis ? "on" : "off") << std::endl;
+        std::cout << "\tLinear scaling: " << (config.Params.LinearScaling ? "on" : "off") << std::endl;
+        std::cout << "\tEphemeral random constants: " << (config.Params.EphemeralConstants ? "on" : "off") << std::endl;
+        std::cout << "\tElites with tuned constants per generation: " << config.Params.TunedElites << std::endl;
+        std::cout << "\tMaximum S-expression depth: " << config.Params.MaxTreeDepth << (config.Params.MaxTreeDepth > 0 ? "" : " (unlimited)") << std::endl;
+        std::cout << "\tMaximum S-expression size: " << config.Params.MaxTreeSize << (config.Params.MaxTreeSize > 0 ? "" : " (unlimited)") << std::endl;
+        std::cout << "\tCrossover retries within limits: " << config.Params.BloatRetries << std::endl;
+        std::cout << "\tTarpeian rate: " << config.Params.TarpeianRate << std::endl;
+        std::cout << "\tSteady state: " << (config.Params.SteadyState ? 
+                (config.Params.ReplaceWorst ? "on, replacing the least fit" : "on, replacing tournament losers") : "off") << std::endl;
+        std::cout << "\tProportion of families bred a generation ahead: " << config.Params.PipelineLag 
+            << (config.Params.PipelineLag > 0.0 ? "" : " (not pipelined)") << std::endl;
+        std::cout << "\tIslands: " << config.Params.Islands;
+        if (config.Params.Islands > 1)
+        {
+            std::cout << ", each sending " << config.Params.Migrants << " migrants every " << config.Params.MigrationInterval 
+                << " generations (" << AsString(config.Params.Topology) << " topology)";
+        }
+        std::cout << std::endl;
+        std::cout << "\tThreads: " << config.Params.Threads << (config.Params.Threads > 0 ? "" : " (one per hardware thread)") << std::endl;
+
+        std::cout << "\tParsimony penalises: " << (config.Params.CostParsimony ? 
+                (config.Params.PrimitiveCosts.empty() ? "evaluation cost (measured)" : "evaluation cost") : "size") << std::endl;
+        for (const auto& [func, cost] : config.Params.PrimitiveCosts)
+        {
+            std::cout << "\t\t" << FunctionFactory::AsString(func) << " cost: " << cost << std::endl;
+        }
 
         std::cout << "\tAllowed functions: ";
         int i = 0;
-        auto size = s_config.Params.AllowedFunctions.size();
-        for (auto& func : s_config.Params.AllowedFunctions)
+        auto size = config.Params.AllowedFunctions.size();
+        for (auto& func : config.Params.AllowedFunctions)
         {
             std::cout << FunctionFactory::AsString(func) << (++i == size ? "\n" : ", ");
         }
 
-        if (s_config.Params.Seed.has_value())
+        if (config.Params.Seed.has_value())
+        {
+            std::cout << "\tSeed: " << config.Params.Seed.value() << std::endl;
+        }
+
+        if (!config.Sweep.Axes.empty())
         {
-            std::cout << "\tSeed: " << s_config.Params.Seed.value() << std::endl;
+            std::cout << "\tSweep: " << (config.Sweep.Random 
+                    ? "random search of " + std::to_string(config.Sweep.Samples) + " configurations" : "grid") << std::endl;
+            for (const auto& axis : config.Sweep.Axes)
+            {
+                std::cout << "\t\t" << axis.Name << ":";
+                for (auto value : axis.Values)
+                {
+                    std::cout << " " << value;
+                }
+                std::cout << std::endl;
+            }
         }
         std::cout << std::endl;
     }
 
-    int ConfigParser::LoadFitnessCases(const std::string& filename)
+    int ConfigParser::LoadFitnessCases(const std::string& filename, std::vector<double>& fitnessCases)
     {
         using Tokenizer = boost::tokenizer<boost::escaped_list_separator<char>>;
         bool isHeader = true; // flags when we're reading the CSV header row
@@ -154,7 +380,7 @@ namespace Model
             {
                 std::string str = *itr;
                 boost::trim(str);
-                s_config.FitnessCases.push_back(boost::lexical_cast<double>(str));
+                fitnessCases.push_back(boost::lexical_cast<double>(str));
             }
         }
         in.close();
@@ -2,6 +2,8 @@
 #define CONFIGPARSER_H
 
 #include <optional>
+#include <string>
+#include <vector>
 #include "PopulationParams.h"
 
 namespace Model
@@ -22,17 +24,17 @@ namespace Model
     private:
         /**
          * Prints the config to stdout
+         * @param config The loaded/default config
          */
-        static void PrintConfig();
+        static void PrintConfig(const Config& config);
 
         /**
          * Loads the fitness cases from the CSV file specified
          * @param filename The CSV file name to load
+         * @param fitnessCases Appended with the fitness cases, row by row
          * @return the number of Terminals in the CSV's fitness cases
          */
-        static int LoadFitnessCases(const std::string& filename);
-
-        static Config s_config; ///< the loaded/default config
+        static int LoadFitnessCases(const std::string& filename, std::vector<double>& fitnessCases);
     };
 }
 #endif 
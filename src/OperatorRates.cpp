@@ -0,0 +1,78 @@
+#include "OperatorRates.h"
+
+#include <algorithm>
+
+namespace Model
+{
+    OperatorRates::OperatorRates(const PopulationParams& params)
+        : m_probabilities{ params.CrossoverProb, params.MutationProb, params.HoistMutationProb }
+        , m_adaptive(params.AdaptiveOperators)
+        , m_minProbability(std::clamp(params.MinOperatorProb, 0.0, 1.0))
+        , m_maxProbability(std::clamp(params.MaxOperatorProb, m_minProbability, 1.0))
+        , m_adaptationRate(std::clamp(params.OperatorAdaptationRate, 0.0, 1.0))
+    {
+        if (m_adaptive)
+        {
+            for (auto& probability : m_probabilities)
+            {
+                probability = std::clamp(probability, m_minProbability, m_maxProbability);
+            }
+        }
+    }
+
+    void OperatorRates::Credit(GeneticOperator op, bool improved)
+    {
+        ++m_applied[Index(op)];
+        if (improved)
+        {
+            ++m_improved[Index(op)];
+        }
+    }
+
+    void OperatorRates::TakeCredit(OperatorRates& other)
+    {
+        for (int i = 0; i < NumberOfGeneticOperators; ++i)
+        {
+            m_applied[i] += other.m_applied[i];
+            m_improved[i] += other.m_improved[i];
+        }
+        other.m_applied.fill(0);
+        other.m_improved.fill(0);
+    }
+
+    void OperatorRates::Adapt()
+    {
+        if (m_adaptive)
+        {
+            // operators that weren't applied have no new credit, so keep their quality
+            for (int i = 0; i < NumberOfGeneticOperators; ++i)
+            {
+                if (m_applied[i] > 0)
+                {
+                    double reward = static_cast<double>(m_improved[i]) / m_applied[i];
+                    m_quality[i] += m_adaptationRate * (reward - m_quality[i]);
+                }
+            }
+
+            auto best = std::max_element(m_quality.begin(), m_quality.end()) - m_quality.begin();
+            for (int i = 0; i < NumberOfGeneticOperators; ++i)
+            {
+                auto target = i == best ? m_maxProbability : m_minProbability;
+                m_probabilities[i] += m_adaptationRate * (target - m_probabilities[i]);
+            }
+
+            // offspring undergo at most one of mutation and hoist mutation
+            auto& mutation = m_probabilities[Index(GeneticOperator::Mutation)];
+            auto& hoist = m_probabilities[Index(GeneticOperator::HoistMutation)];
+            if (mutation + hoist > 1.0)
+            {
+                auto total = mutation + hoist;
+                mutation /= total;
+                hoist /= total;
+            }
+        }
+
+        m_applied.fill(0);
+        m_improved.fill(0);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef OperatorRates_H
+#define OperatorRates_H
+
+#include <array>
+#include "model/GeneticOperator.h"
+#include "PopulationParams.h"
+
+namespace Model
+{
+    /**
+     * The probability of applying each genetic operator to offspring.
+     *
+     * If adaptive, the probabilities are adapted once per generation by adaptive pursuit: each operator is
+     * credited with the proportion of the offspring it modified that came out fitter than their parents, the
+     * quality of each operator is a moving average of its credit, and the probability of the best operator is
+     * pursued towards the maximum probability while the rest are pursued towards the minimum.
+     */
+    class OperatorRates
+    {
+    public:
+        /**
+         * Constructor - every probability is 0, and never adapts
+         */
+        OperatorRates() = default;
+
+        /**
+         * Constructor
+         * @param params The initial probability of each operator, and how they adapt
+         */
+        explicit OperatorRates(const PopulationParams& params);
+
+        /**
+         * @return the probability of applying the operator
+         */
+        double Probability(GeneticOperator op) const { return m_probabilities[Index(op)]; }
+
+        /**
+         * Credits an operator that modified an offspring
+         * @param improved Whether the offspring was fitter than its parents
+         */
+        void Credit(GeneticOperator op, bool improved);
+
+        /**
+         * Takes the credit tallied by another instance, such as by a worker thread, and clears it there
+         * @param other The tally
+         */
+        void TakeCredit(OperatorRates& other);
+
+        /**
+         * Adapts the probabilities to the credit since the last adaptation, if adaptive, then clears the credit
+         */
+        void Adapt();
+
+    private:
+        /**
+         * @return the index of an operator in the arrays below
+         */
+        static int Index(GeneticOperator op) { return static_cast<int>(op); }
+
+        using Rates = std::array<double, NumberOfGeneticOperators>;
+        using Counts = std::array<long, NumberOfGeneticOperators>;
+
+        Rates m_probabilities{}; ///< The probability of applying each operator
+        Rates m_quality{}; ///< The moving average of the proportion of improved offspring, per operator
+        Counts m_applied{}; ///< The number of offspring modified by each operator since the last adaptation
+        Counts m_improved{}; ///< The number of those offspring that were fitter than their parents
+        bool m_adaptive = false; ///< Whether the probabilities adapt
+        double m_minProbability = 0.0; ///< The lower bound of each probability
+        double m_maxProbability = 1.0; ///< The upper bound of each probability
+        double m_adaptationRate = 0.0; ///< The rate at which the quality and probabilities adapt, in [0,1]
+    };
+}
+
+#endif
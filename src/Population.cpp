@@ -1,11 +1,16 @@
 #include "Population.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <limits>
+#include <numeric>
 // #include <iostream>
 #include <stdexcept>
+#include <thread>
+#include <utility>
 #include "model/FunctionFactory.h"
-#include "model/ChromosomeFactory.h"
 #include "model/ChromosomeUtil.h"
 #include "utils/Math.h"
 #include "utils/Raffle.h"
@@ -42,57 +47,161 @@ namespace
 namespace Model
 {
     Population::Population(const PopulationParams& params, const std::vector<double>& fitnessCases)
+        : Population(params, std::make_shared<const std::vector<double>>(fitnessCases), 
+                std::make_shared<std::vector<double>>(params.NumberOfTerminals), nullptr)
+    {
+    }
+
+    Population::Population(const PopulationParams& params, std::shared_ptr<const std::vector<double>> fitnessCases, 
+            std::shared_ptr<std::vector<double>> terminals, const Population* mainland)
         : m_params(params)
-        , m_randomProbability(.0, 1.)
         // TODO: allow config to select between raffle and tournament style selection
         // , m_selector(std::make_unique<Util::Raffle<double>>())
         // TODO: make the tournament size configurable by XML
         , m_selector(std::make_unique<Util::Tournament<double>>(m_params.PopulationSize, TournamentSize))
-        , m_terminals(params.NumberOfTerminals)
-        , m_fitnessCases(fitnessCases)
+        , m_terminals(std::move(terminals))
+        , m_fitnessCases(std::move(fitnessCases))
+        , m_randomSeed(0, std::numeric_limits<int>::max())
+        , m_mainland(mainland)
     {
         if (params.Seed.has_value())
         {
-            ChromosomeUtil::SetSeed(params.Seed.value());
-            m_randomProbability.SetSeed(params.Seed.value());
+            m_randomSeed.SetSeed(params.Seed.value());
             m_selector->SetSeed(params.Seed.value());
         }
 
         // make sure user input params are valid
         m_params.CarryOverProportion = std::clamp(m_params.CarryOverProportion, 0.0, 1.0);
+        m_params.PipelineLag = std::clamp(m_params.PipelineLag, 0.0, 1.0);
         m_params.TwinsPerMatingPair = std::max(1, m_params.TwinsPerMatingPair);
+        if (m_params.Type == ChromosomeType::GeometricSemantic)
+        {
+            // geometric semantic offspring are larger than their parents by design, so size isn't penalised
+            m_params.ParsimonyCoefficient = 0.0;
+            m_params.TarpeianRate = 0.0;
+        }
+        if (m_params.Threads <= 0)
+        {
+            m_params.Threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+        m_workers.resize(m_params.Threads);
+        for (auto& worker : m_workers)
+        {
+            worker.Terminals.resize(m_terminals->size());
+        }
+        m_scheduler = std::make_unique<Util::WorkStealingScheduler>(m_params.Threads);
+        m_rowPartition = std::make_unique<RowPartition>(m_scheduler->Pool(), *m_terminals);
 
-        for (auto& terminal : m_terminals)
+        for (auto& terminal : *m_terminals)
         {
             m_allowedTerminals.push_back(&terminal);
         }
 
-        ChromosomeFactory::Initialise(m_params.Type, m_params.MinInitialTreeSize, 
-                m_params.AllowedFunctions, m_allowedTerminals, m_fitnessCases, m_terminals);
+        m_terminalSet = m_allowedTerminals;
+        if (m_params.EphemeralConstants)
+        {
+            m_terminalSet.push_back(nullptr);
+        }
+        m_mutations = MutationTable(m_params.AllowedFunctions, m_terminalSet);
+        m_limits = { m_params.MaxTreeDepth, m_params.MaxTreeSize, std::max(0, m_params.BloatRetries) };
+
+        if (m_params.CostParsimony)
+        {
+            // islands share the mainland's costs, rather than measure their own
+            m_costs = mainland ? mainland->m_costs : m_params.PrimitiveCosts.empty() 
+                ? CostTable::Calibrate(m_params.AllowedFunctions) : CostTable(m_params.PrimitiveCosts);
+        }
+
+        // each island has an even share of the population, and one thread
+        m_params.Islands = mainland ? 1 : std::clamp(m_params.Islands, 1, std::max(1, m_params.PopulationSize / 2));
+        if (m_params.Islands > 1)
+        {
+            for (int i = 0; i < m_params.Islands; ++i)
+            {
+                auto island = m_params;
+                island.Islands = 1;
+                island.Threads = 1;
+                island.PopulationSize = m_params.PopulationSize / m_params.Islands 
+                    + (i < m_params.PopulationSize % m_params.Islands ? 1 : 0);
+                if (m_params.Seed.has_value())
+                {
+                    island.Seed = m_randomSeed.Get();
+                }
+                m_islands.push_back(std::unique_ptr<Population>(new Population(island, m_fitnessCases, m_terminals, this)));
+            }
+            m_mailboxes = std::vector<Util::Mailbox<Migrant>>(2 * m_params.Islands);
+        }
     }
 
     void Population::Reset()
     {
-        m_population.clear();
+        m_population.Clear();
         m_selector->Reset();
+        m_culled = 0;
+        m_culledNodes = 0;
+        m_rates = OperatorRates(m_params);
+        m_scheduler->ResetStatistics();
+        m_generation = 0;
+        m_bredAhead.clear();
+        m_breeding = 0.0;
+        m_hiddenBreeding = 0.0;
+
+        if (!m_mainland)
+        {
+            InitialiseFactory();
+        }
+        if (!m_islands.empty())
+        {
+            ResetIslands();
+            return;
+        }
+
+        // generate an appropriately sized population, then evaluate it as one batch across the workers.
+        // The calling thread may have been used by another population, so is reseeded from this one's seeds.
+        ChromosomeUtil::SetSeed(m_randomSeed.Get());
+        auto trees = Factory().CreateUniqueRandomTrees(m_params.PopulationSize, m_scheduler->Pool());
+        std::vector<double> costs(trees.size());
+        for (auto i = 0u; i < trees.size(); ++i)
+        {
+            costs[i] = EstimateCost(m_costs ? trees[i]->Cost(*m_costs) : trees[i]->Size());
+        }
+
+        std::vector<ChromoPtr> chromosomes(trees.size());
+        RunBatch(costs, [&](int i, Worker& worker)
+        {
+            chromosomes[i] = Factory().CopyAndEvaluate(std::move(trees[i]), m_parsimonyCoefficient,
+                    std::numeric_limits<double>::max(), worker.Terminals, worker.Rows);
+        });
 
-        // generate an appropriately sized population
-        for (auto i = 0; i < m_params.PopulationSize; ++i)
+        m_population.Reserve(m_params.PopulationSize);
+        for (auto& chromosome : chromosomes)
         {
-            m_population.push_back(ChromosomeFactory::Inst().CreateRandom(m_parsimonyCoefficient));
+            m_population.Add(std::move(chromosome));
         }
         RecalibrateParentSelector(); // TODO
     }
 
     void Population::Evolve()
     {
+        if (!m_islands.empty())
+        {
+            EvolveIslands();
+            return;
+        }
+        if (m_params.SteadyState)
+        {
+            EvolveSteadyState();
+            return;
+        }
+
         // Create a new population
-        std::vector<Population::ChromoPtr> newPopulation;
+        PopulationStore newPopulation;
+        newPopulation.Reserve(m_population.Size());
 
         // copy the best proportion
         if (m_params.CarryOverProportion > 0.0)
         {
-            auto numToClone = static_cast<int>(m_params.CarryOverProportion * m_population.size());
+            auto numToClone = static_cast<int>(m_params.CarryOverProportion * m_population.Size());
             if (numToClone % 2 == 1)
             {
                 ++numToClone; // needs to be an even number
@@ -100,143 +209,598 @@ namespace Model
 
             for (int i = 0; i < numToClone; ++i)
             {
-                newPopulation.push_back(m_sortedByFitness[i]->Clone());
+                newPopulation.Add(m_population[m_population.ByFitness()[i]].Clone());
+            }
+        }
+
+        // The first families were bred ahead during the last generation, so need only be evaluated. If pipelined,
+        // this generation's tasks are followed by breeding ahead some of the next generation's families.
+        auto bredAhead = std::exchange(m_bredAhead, {});
+        int families = (m_population.Size() - newPopulation.Size() + 1) / 2; // each adds two offspring
+        int early = std::min(static_cast<int>(bredAhead.size()), families);
+        int ahead = static_cast<int>(std::lround(m_params.PipelineLag * families));
+        int tasks = families + ahead;
+
+        // select every breeding pair up front, since the selector draws from a single random stream
+        std::vector<std::tuple<const IChromosome*, const IChromosome*>> parents(tasks - early);
+        for (auto& pair : parents)
+        {
+            pair = SelectParents(); // raw pointers to Chromosome
+        }
+
+        // A family costs about as much to evaluate as its parents, for each pair of twins. Breeding one ahead
+        // costs about as much as copying them for each fitness case, so those tasks are dealt last, and are the
+        // first stolen by workers that run out of evaluations.
+        std::vector<int> seeds(tasks);
+        std::vector<double> costs(tasks);
+        for (int i = 0; i < tasks; ++i)
+        {
+            seeds[i] = m_randomSeed.Get();
+            if (i < early)
+            {
+                double cost = 0.0;
+                for (const auto& child : bredAhead[i].Offspring)
+                {
+                    cost += child->Cost();
+                }
+                costs[i] = EstimateCost(cost);
+                continue;
             }
+            auto [mum, dad] = parents[i - early];
+            double cost = m_params.TwinsPerMatingPair * (mum->Cost() + dad->Cost());
+            costs[i] = i < families ? EstimateCost(cost) : cost;
         }
 
-        while (newPopulation.size() < m_population.size())
+        // workers breed the families with their own terminals, but each family with its own random numbers
+        using Clock = std::chrono::steady_clock;
+        std::vector<Clock::time_point> started(tasks);
+        std::vector<Clock::time_point> finished(tasks);
+        std::vector<std::vector<ChromoPtr>> offspring(families);
+        std::vector<BredFamily> nextFamilies(ahead);
+        RunBatch(costs, [&](int i, Worker& worker)
+        {
+            ChromosomeUtil::SetSeed(seeds[i]);
+            worker.RandomProbability.SetSeed(ChromosomeUtil::RandInt().GetInRange(0, std::numeric_limits<int>::max()));
+            started[i] = Clock::now();
+            if (i < early)
+            {
+                offspring[i] = EvaluateFamily(std::move(bredAhead[i]), worker);
+            }
+            else if (i < families)
+            {
+                auto [mum, dad] = parents[i - early];
+                offspring[i] = Reproduce(*mum, *dad, worker);
+            }
+            else
+            {
+                auto [mum, dad] = parents[i - early];
+                nextFamilies[i - families] = BreedFamily(*mum, *dad, worker);
+            }
+            finished[i] = Clock::now();
+        });
+        ChromosomeUtil::SetSeed(m_randomSeed.Get()); // the calling thread was reseeded by whichever families it bred
+
+        // breeding ahead was hidden for as long as another worker was still evaluating this generation
+        if (ahead > 0 && families > 0)
         {
-            // select a breeding pair
-            auto [mum, dad] = SelectParents(); // raw pointers to Chromosome
-            // std::cout << "parents:" << std::endl;
-            // std::cout << "\tfitness: " << mum->Fitness() << "\t" << mum->GetTree()->ToString() << std::endl;
-            // std::cout << "\tfitness: " << dad->Fitness() << "\t" << dad->GetTree()->ToString() << std::endl;
+            auto evaluated = *std::max_element(finished.begin(), finished.begin() + families);
+            for (int i = families; i < tasks; ++i)
+            {
+                std::chrono::duration<double> hidden = std::min(finished[i], evaluated) - started[i];
+                m_hiddenBreeding += std::max(0.0, hidden.count());
+            }
+        }
+        m_bredAhead = std::move(nextFamilies);
 
-            // perform a deep copy, crossover & mutation
-            Reproduce(*mum, *dad, newPopulation); // unique pointers
-            // auto lastItr = newPopulation.end()-1;
-            // std::cout << "children:" << std::endl;
-            // std::cout << "\tfitness: " << CalculateChromosomeFitness(*lastItr->GetTree()) << "\t" << lastItr->GetTree()->ToString() << std::endl;
-            // std::cout << "\tfitness: " << CalculateChromosomeFitness(*(lastItr-1)->GetTree()) << "\t" << (lastItr-1)->GetTree()->ToString() << std::endl << std::endl;
+        // then gather the offspring and the workers' tallies in order, so the result doesn't depend on timing
+        for (auto& family : offspring)
+        {
+            for (auto& child : family)
+            {
+                newPopulation.Add(std::move(child));
+            }
         }
-        m_population.swap(newPopulation);
+        CollectWorkerTallies();
+        m_population.Swap(newPopulation);
+        m_rates.Adapt();
 
         // calculate the fitness of the new population
         RecalibrateParentSelector(); 
     }
 
-    void Population::Reproduce(const IChromosome& mum, const IChromosome& dad, std::vector<Population::ChromoPtr>& nextGeneration)
+    void Population::EvolveSteadyState()
     {
-        std::vector<Population::ChromoPtr> family;
+        SteadyStateStore store(m_population.Release());
+
+        // if the fitness cases are worth splitting, a single worker splits each evaluation across the threads
+        auto rows = RowsFor(m_params.PopulationSize);
+        std::vector<int> seeds(rows ? 1 : m_scheduler->Size());
+        for (auto& seed : seeds)
+        {
+            seed = m_randomSeed.Get();
+        }
+
+        // each family adds two offspring, until there have been as many as there are individuals
+        std::atomic<int> births{ 0 };
+        auto breed = [&](int w)
+        {
+            auto& worker = m_workers[w];
+            worker.Rows = rows;
+            ChromosomeUtil::SetSeed(seeds[w]);
+            worker.RandomProbability.SetSeed(ChromosomeUtil::RandInt().GetInRange(0, std::numeric_limits<int>::max()));
+            while (births.fetch_add(2, std::memory_order_relaxed) < store.Size())
+            {
+                auto mum = std::get<1>(Contest(store, true));
+                auto dad = std::get<1>(Contest(store, true));
+                for (auto& child : Reproduce(*mum, *dad, worker))
+                {
+                    Insert(store, std::move(child));
+                }
+            }
+            worker.Rows = nullptr;
+        };
+        if (rows)
+        {
+            breed(0);
+        }
+        else
+        {
+            m_scheduler->Pool().Run(breed);
+        }
+        ChromosomeUtil::SetSeed(m_randomSeed.Get()); // the calling thread was reseeded as a worker
+
+        for (auto& chromosome : store.Release())
+        {
+            m_population.Add(std::move(chromosome));
+        }
+        CollectWorkerTallies();
+        m_rates.Adapt();
+        RecalibrateParentSelector();
+    }
+
+    std::tuple<int, const IChromosome*> Population::Contest(const SteadyStateStore& store, bool fittest) const
+    {
+        auto fitter = [fittest](const IChromosome* a, const IChromosome* b)
+        {
+            return fittest ? a->WeightedFitness() < b->WeightedFitness() : a->WeightedFitness() > b->WeightedFitness();
+        };
+
+        bool everySlot = !fittest && m_params.ReplaceWorst;
+        int contestants = everySlot ? store.Size() : std::min(TournamentSize, store.Size());
+        int winner = -1;
+        const IChromosome* chromosome = nullptr;
+        for (int i = 0; i < contestants; ++i)
+        {
+            int slot = everySlot ? i : ChromosomeUtil::RandInt().GetInRange(0, store.Size() - 1);
+            auto contestant = store.Get(slot);
+            if (!chromosome || fitter(contestant, chromosome))
+            {
+                winner = slot;
+                chromosome = contestant;
+            }
+        }
+        return { winner, chromosome };
+    }
+
+    void Population::Insert(SteadyStateStore& store, ChromoPtr child) const
+    {
+        // another worker may replace the loser first, in which case the offspring contests another
+        const int Attempts = 3;
+        for (int attempt = 0; attempt < Attempts; ++attempt)
+        {
+            auto [slot, loser] = Contest(store, false);
+            if (child->WeightedFitness() >= loser->WeightedFitness() || store.Replace(slot, loser, child))
+            {
+                return;
+            }
+        }
+    }
+
+    void Population::CollectWorkerTallies()
+    {
+        for (auto& worker : m_workers)
+        {
+            m_rates.TakeCredit(worker.Tally);
+            m_culled += std::exchange(worker.Culled, 0);
+            m_culledNodes += std::exchange(worker.CulledNodes, 0);
+            m_breeding += std::exchange(worker.Breeding, 0.0);
+        }
+    }
+
+    std::vector<std::unique_ptr<Population>> Population::Replicate(const std::vector<PopulationParams>& params)
+    {
+        InitialiseFactory();
+        std::vector<std::unique_ptr<Population>> replicas;
+        for (const auto& replica : params)
+        {
+            replicas.push_back(std::unique_ptr<Population>(new Population(replica, m_fitnessCases, m_terminals, this)));
+        }
+        return replicas;
+    }
+
+    void Population::InitialiseFactory()
+    {
+        // a new factory, so that a geometric semantic genealogy starts afresh
+        m_factory = std::make_unique<const ChromosomeFactory>(m_params, m_allowedTerminals, m_terminalSet,
+                *m_fitnessCases, *m_terminals, m_costs ? &*m_costs : nullptr);
+    }
+
+    const ChromosomeFactory& Population::Factory() const
+    {
+        return m_mainland ? m_mainland->Factory() : *m_factory;
+    }
+
+    void Population::ResetIslands()
+    {
+        for (auto& mailbox : m_mailboxes)
+        {
+            mailbox.TakeAll(); // discard the migrants of the last run
+        }
+
+        // each island creates its initial population with its own random numbers
+        m_scheduler->Run(std::vector<double>(m_islands.size(), 1.0), [&](int i, int)
+        {
+            m_islands[i]->Reset();
+        });
+        ChromosomeUtil::SetSeed(m_randomSeed.Get()); // the calling thread was reseeded by whichever islands it reset
+    }
+
+    void Population::EvolveIslands()
+    {
+        int islands = static_cast<int>(m_islands.size());
+        bool migrate = m_params.MigrationInterval > 0 && (m_generation + 1) % m_params.MigrationInterval == 0;
+        auto destinations = migrate ? MigrationDestinations() : std::vector<std::vector<int>>();
+        auto* posting = &m_mailboxes[(m_generation % 2) * islands];
+        auto* taking = &m_mailboxes[((m_generation + 1) % 2) * islands];
+
+        // islands are about the same size, so cost about the same to evolve
+        std::vector<double> costs(islands);
+        for (int i = 0; i < islands; ++i)
+        {
+            costs[i] = m_islands[i]->m_population.Size();
+        }
+
+        // the mailboxes are the only state the islands share
+        m_scheduler->Run(costs, [&](int i, int)
+        {
+            auto& island = *m_islands[i];
+            island.Immigrate(taking[i].TakeAll());
+            island.Evolve();
+            if (migrate)
+            {
+                const auto& ranked = island.m_population.ByWeightedFitness();
+                int migrants = std::min(m_params.Migrants, island.m_population.Size());
+                for (auto destination : destinations[i])
+                {
+                    for (int rank = 0; rank < migrants; ++rank)
+                    {
+                        posting[destination].Post({ island.m_population[ranked[rank]].Clone(), i, rank });
+                    }
+                }
+            }
+        });
+        ChromosomeUtil::SetSeed(m_randomSeed.Get()); // the calling thread was reseeded by whichever islands it evolved
+        ++m_generation;
+    }
+
+    std::vector<std::vector<int>> Population::MigrationDestinations()
+    {
+        int islands = static_cast<int>(m_islands.size());
+        std::vector<std::vector<int>> destinations(islands);
+        for (int i = 0; i < islands; ++i)
+        {
+            switch (m_params.Topology)
+            {
+            case MigrationTopology::Random:
+            {
+                int other = m_randomSeed.Get() % (islands - 1); // any island but this one
+                destinations[i].push_back(other < i ? other : other + 1);
+                break;
+            }
+            case MigrationTopology::FullyConnected:
+                for (int j = 0; j < islands; ++j)
+                {
+                    if (j != i)
+                    {
+                        destinations[i].push_back(j);
+                    }
+                }
+                break;
+
+            case MigrationTopology::Ring:
+            default:
+                destinations[i].push_back((i + 1) % islands);
+                break;
+            }
+        }
+        return destinations;
+    }
+
+    void Population::Immigrate(std::vector<Migrant> immigrants)
+    {
+        if (immigrants.empty())
+        {
+            return;
+        }
+
+        // order the immigrants by fitness here, then by where they came from, since they arrive in any order
+        for (auto& immigrant : immigrants)
+        {
+            immigrant.Individual->Reweigh(m_parsimonyCoefficient);
+        }
+        std::sort(immigrants.begin(), immigrants.end(), [](const Migrant& a, const Migrant& b)
+        {
+            return std::make_tuple(a.Individual->WeightedFitness(), a.Island, a.Rank) 
+                < std::make_tuple(b.Individual->WeightedFitness(), b.Island, b.Rank);
+        });
+
+        // the fittest immigrants replace the least fit individuals
+        const auto& ranked = m_population.ByWeightedFitness();
+        int count = std::min({ m_params.Migrants, static_cast<int>(immigrants.size()), m_population.Size() });
+        std::vector<int> leastFit(ranked.end() - count, ranked.end());
+        for (int i = 0; i < count; ++i)
+        {
+            m_population.Replace(leastFit[i], std::move(immigrants[i].Individual));
+        }
+        RecalibrateParentSelector();
+    }
+
+    std::vector<const Population*> Population::Demes() const
+    {
+        if (m_islands.empty())
+        {
+            return { this };
+        }
+
+        std::vector<const Population*> demes;
+        for (const auto& island : m_islands)
+        {
+            demes.push_back(island.get());
+        }
+        return demes;
+    }
+
+    const IChromosome& Population::Fittest() const
+    {
+        const IChromosome* fittest = nullptr;
+        for (auto deme : Demes())
+        {
+            const auto& best = deme->m_population[deme->m_population.ByWeightedFitness()[0]];
+            if (!fittest || best.WeightedFitness() < fittest->WeightedFitness())
+            {
+                fittest = &best;
+            }
+        }
+        return *fittest;
+    }
+
+    std::vector<Population::ChromoPtr> Population::Reproduce(const IChromosome& mum, const IChromosome& dad, 
+            Worker& worker) const
+    {
+        return EvaluateFamily(BreedFamily(mum, dad, worker), worker);
+    }
+
+    Population::BredFamily Population::BreedFamily(const IChromosome& mum, const IChromosome& dad, 
+            Worker& worker) const
+    {
+        // breed the whole family before evaluating any of it
+        auto start = std::chrono::steady_clock::now();
+        BredFamily family{ {}, std::min(mum.Fitness(), dad.Fitness()) };
+        family.Offspring.reserve(2 * m_params.TwinsPerMatingPair);
         for (int i = 0; i < m_params.TwinsPerMatingPair; ++i)
         {
-            auto [son, daughter] = GetNewOffspring(mum, dad, m_fitnessCases, m_terminals, m_parsimonyCoefficient);
-            family.push_back(std::move(son));
-            family.push_back(std::move(daughter));
+            auto [son, daughter] = Breed(mum, dad, worker);
+            family.Offspring.push_back(std::move(son));
+            family.Offspring.push_back(std::move(daughter));
+        }
+        std::chrono::duration<double> breeding = std::chrono::steady_clock::now() - start;
+        worker.Breeding += breeding.count();
+        return family;
+    }
+
+    std::vector<Population::ChromoPtr> Population::EvaluateFamily(BredFamily bred, Worker& worker) const
+    {
+        auto& family = bred.Offspring;
+
+        // Only the best two of the family survive, so each child need only be evaluated far enough to know
+        // whether it beats the current second best. Unmodified copies of the parents cost nothing to evaluate,
+        // and small S-expressions little, so evaluating them first tightens the cutoff for the rest.
+        std::stable_sort(family.begin(), family.end(), [](const ChromoPtr& a, const ChromoPtr& b)
+        {
+            return std::make_tuple(a->IsModified(), a->Size()) < std::make_tuple(b->IsModified(), b->Size());
+        });
+
+        double best = std::numeric_limits<double>::max();
+        double secondBest = std::numeric_limits<double>::max();
+        for (auto& child : family)
+        {
+            child = Evaluate(std::move(child), worker, m_parsimonyCoefficient, secondBest, bred.ParentFitness);
+            auto weightedFitness = child->WeightedFitness();
+            if (weightedFitness < best)
+            {
+                secondBest = best;
+                best = weightedFitness;
+            }
+            else if (weightedFitness < secondBest)
+            {
+                secondBest = weightedFitness;
+            }
         }
-        std::sort(family.begin(), family.end(), ChromoPtrOrder);
 
-        auto inOrder = family.begin();
-        nextGeneration.push_back(std::move(*inOrder));
-        ++inOrder;
-        nextGeneration.push_back(std::move(*inOrder));
+        auto survivors = std::min<std::size_t>(2, family.size());
+        std::partial_sort(family.begin(), family.begin() + survivors, family.end(), ChromoPtrOrder);
+        family.resize(survivors);
+        return std::move(family);
+    }
+
+    std::tuple<Population::ChromoPtr, Population::ChromoPtr> Population::GetNewOffspring(const IChromosome& mum, const IChromosome& dad, Worker& worker, double parsimonyCoefficient, double cutoff) const
+    {
+        auto [son, daughter] = Breed(mum, dad, worker);
+        double parentFitness = std::min(mum.Fitness(), dad.Fitness());
+        return { Evaluate(std::move(son), worker, parsimonyCoefficient, cutoff, parentFitness), 
+            Evaluate(std::move(daughter), worker, parsimonyCoefficient, cutoff, parentFitness) };
     }
 
-    std::tuple<Population::ChromoPtr, Population::ChromoPtr> Population::GetNewOffspring(const IChromosome& mum, const IChromosome& dad, const std::vector<double>& fitnessCases, std::vector<double>& terminals, double parsimonyCoefficient) const
+    std::tuple<Population::ChromoPtr, Population::ChromoPtr> Population::Breed(const IChromosome& mum, const IChromosome& dad, Worker& worker) const
     {
         // Deep copy mum & dad
         auto son = dad.Clone();
         auto daughter = mum.Clone();
 
         // should we crossover? 
-        if (m_randomProbability.Get() <= m_params.CrossoverProb)
+        if (worker.RandomProbability.Get() <= m_rates.Probability(GeneticOperator::Crossover))
         {
-            son->Crossover(*daughter);
+            son->Crossover(*daughter, m_limits);
         }
 
         // should we mutate son?
-        auto mutationLikelihood = m_randomProbability.Get();
-        if (mutationLikelihood <= m_params.MutationProb)
+        auto mutationProb = m_rates.Probability(GeneticOperator::Mutation);
+        auto hoistMutationProb = m_rates.Probability(GeneticOperator::HoistMutation);
+        auto mutationLikelihood = worker.RandomProbability.Get();
+        if (mutationLikelihood <= mutationProb)
         {
-            son->Mutate(m_params.AllowedFunctions, m_allowedTerminals);
+            son->Mutate(m_mutations);
         }
-        else if (mutationLikelihood <= m_params.MutationProb + m_params.HoistMutationProb)
+        else if (mutationLikelihood <= mutationProb + hoistMutationProb)
         {
             son->HoistMutate();
         }
 
         // should we mutate daughter?
-        mutationLikelihood = m_randomProbability.Get();
-        if (mutationLikelihood <= m_params.MutationProb)
+        mutationLikelihood = worker.RandomProbability.Get();
+        if (mutationLikelihood <= mutationProb)
         {
-            daughter->Mutate(m_params.AllowedFunctions, m_allowedTerminals);
+            daughter->Mutate(m_mutations);
         }
-        else if (mutationLikelihood <= m_params.MutationProb + m_params.HoistMutationProb)
+        else if (mutationLikelihood <= mutationProb + hoistMutationProb)
         {
             daughter->HoistMutate();
         }
+        return { std::move(son), std::move(daughter) };
+    }
 
-        return 
+    Population::ChromoPtr Population::Evaluate(ChromoPtr child, Worker& worker, double parsimonyCoefficient, double cutoff, 
+            double parentFitness) const
+    {
+        // offspring that weren't modified are exact copies of their parent, so needn't be re-evaluated
+        if (!child->IsModified())
         {
-            ChromosomeFactory::Inst().CopyAndEvaluate(std::move(son->GetTree()), parsimonyCoefficient),
-            ChromosomeFactory::Inst().CopyAndEvaluate(std::move(daughter->GetTree()), parsimonyCoefficient),
-        };
+            child->Reweigh(parsimonyCoefficient);
+            return child;
+        }
+        if (m_params.TarpeianRate > 0.0 && child->Size() > m_averageSize 
+                && worker.RandomProbability.Get() < m_params.TarpeianRate)
+        {
+            ++worker.Culled;
+            worker.CulledNodes += child->Size();
+            return Factory().CreateUnevaluated(std::move(child->GetTree()), parsimonyCoefficient);
+        }
+        std::vector<GeneticOperator> operators;
+        for (auto op : { GeneticOperator::Crossover, GeneticOperator::Mutation, GeneticOperator::HoistMutation })
+        {
+            if (child->IsModifiedBy(op))
+            {
+                operators.push_back(op);
+            }
+        }
+        auto evaluated = Factory().Evaluate(std::move(child), parsimonyCoefficient, worker.Terminals, cutoff, 
+                worker.Rows);
+
+        // offspring are only known to be fitter than their parents if they were evaluated in full
+        bool improved = evaluated->WeightedFitness() <= cutoff && evaluated->Fitness() < parentFitness;
+        for (auto op : operators)
+        {
+            worker.Tally.Credit(op, improved);
+        }
+        return evaluated;
     }
 
     void Population::RecalibrateParentSelector()
     {
         SortPopulation();
+        TuneElites();
 
         m_selector->Reset(); // get rid of the previous generation's tickets
         
-        int i = 0;
-        for (auto& chromosome : m_population)
+        // selectors draw a rank, where rank 0 has the best weighted fitness
+        const auto& fitness = m_population.Fitness();
+        const auto& ranked = m_population.ByWeightedFitness();
+        for (auto rank = 0u; rank < ranked.size(); ++rank)
         {
             // TODO: only calculate ticketAllocation for raffle style
-            // auto numberOfTickets = ticketAllocation(chromosome.Fitness());
-            auto numberOfTickets = chromosome->Fitness();
-            m_selector->RegisterElement(numberOfTickets, i);
-            ++i;
+            // auto numberOfTickets = ticketAllocation(fitness[ranked[rank]]);
+            auto numberOfTickets = fitness[ranked[rank]];
+            m_selector->RegisterElement(numberOfTickets, rank);
         }
         m_parsimonyCoefficient = UpdateParsimonyCoefficient();
+
+        const auto& sizes = m_population.Sizes();
+        m_averageSize = Util::Average(sizes.begin(), sizes.end());
         // std::cout << "Parsimony Coefficient = " << m_parsimonyCoefficient << std::endl;
     }
     
-    void Population::SortPopulation()
+    void Population::TuneElites()
     {
-        // sort primary population by WeightedFitness
-        std::sort(m_population.begin(), m_population.end(), ChromoPtrOrder);
+        auto numToTune = std::clamp(m_params.TunedElites, 0, m_population.Size());
+        if (numToTune == 0)
+        {
+            return;
+        }
 
-        // sort pointers by fitness
-        m_sortedByFitness.clear();
-        for (auto& p : m_population)
+        // copy the IDs, since replacing a chromosome invalidates the order
+        std::vector<int> elites(m_population.ByWeightedFitness().begin(), m_population.ByWeightedFitness().begin() + numToTune);
+        for (auto id : elites)
         {
-            m_sortedByFitness.push_back(p.get());
+            if (auto tuned = Factory().TuneConstants(m_population[id], m_parsimonyCoefficient, 
+                    m_workers[0].Terminals, RowsFor(1)))
+            {
+                m_population.Replace(id, std::move(tuned));
+            }
         }
-        std::sort(m_sortedByFitness.begin(), m_sortedByFitness.end(), [](const IChromosome* a, const IChromosome* b) { return a->Fitness() < b->Fitness(); });
+        SortPopulation();
+    }
+
+    void Population::SortPopulation()
+    {
+        m_population.Sort();
     }
 
-    std::tuple<IChromosome*, IChromosome*> Population::SelectParents()
+    std::tuple<const IChromosome*, const IChromosome*> Population::SelectParents() const
     {
-        int mum = m_selector->Draw();
-        int dad = m_selector->Draw();
-        return std::make_tuple( m_population[mum].get(), m_population[dad].get() );
+        const auto& ranked = m_population.ByWeightedFitness();
+        int mum = ranked[m_selector->Draw()];
+        int dad = ranked[m_selector->Draw()];
+        return std::make_tuple( &m_population[mum], &m_population[dad] );
     }
 
     std::tuple<double, double, double, double, double> Population::GetRangeStatistics() const
     {
-        auto size = m_population.size();
-        auto min = m_sortedByFitness[0]->Fitness();
-        auto max = m_sortedByFitness[size-1]->Fitness();
+        // the fitness of every individual on every island, in order
+        std::vector<double> sorted;
+        for (auto deme : Demes())
+        {
+            const auto& fitness = deme->m_population.Fitness();
+            for (auto id : deme->m_population.ByFitness())
+            {
+                sorted.push_back(fitness[id]);
+            }
+        }
+        if (!m_islands.empty())
+        {
+            std::sort(sorted.begin(), sorted.end());
+        }
+        auto size = sorted.size();
+        auto min = sorted[0];
+        auto max = sorted[size-1];
 
         auto getMedian = [&](int begin, int end)
         {
             auto size = end - begin;
             auto middle = begin + size/2;
-            double median = m_sortedByFitness[middle]->Fitness();
+            double median = sorted[middle];
             if (size % 2 == 0) // even
             {
-                auto middleLeft = m_sortedByFitness[middle-1]->Fitness();
+                auto middleLeft = sorted[middle-1];
                 // if even, need to return the average of the middle two elems
                 median = (middleLeft + median) * 0.5;
             }
@@ -252,14 +816,120 @@ namespace Model
 
     double Population::GetAverageFitness() const
     {
-        using ConstItr = std::vector<Population::ChromoPtr>::const_iterator;
-        auto getFitness = [](const ConstItr& itr) { return (*itr)->Fitness(); };
-        return Util::Average<ConstItr>(m_population.begin(), m_population.end(), getFitness);
+        if (m_islands.empty())
+        {
+            const auto& fitness = m_population.Fitness();
+            return Util::Average(fitness.begin(), fitness.end());
+        }
+
+        double sum = 0.0;
+        int count = 0;
+        for (auto deme : Demes())
+        {
+            const auto& fitness = deme->m_population.Fitness();
+            sum += std::accumulate(fitness.begin(), fitness.end(), 0.0);
+            count += fitness.size();
+        }
+        return sum / count;
     }
 
     Population::ChromoPtr Population::GetBestFit() const
     {
-        return m_sortedByFitness[0]->Clone();
+        const IChromosome* best = nullptr;
+        for (auto deme : Demes())
+        {
+            const auto& fittest = deme->m_population[deme->m_population.ByFitness()[0]];
+            if (!best || fittest.Fitness() < best->Fitness())
+            {
+                best = &fittest;
+            }
+        }
+        return best->Clone();
+    }
+
+    std::tuple<long, long> Population::GetCullingStatistics() const
+    {
+        long culled = 0;
+        long culledNodes = 0;
+        for (auto deme : Demes())
+        {
+            culled += deme->m_culled;
+            culledNodes += deme->m_culledNodes;
+        }
+        return { culled, culledNodes };
+    }
+
+    std::tuple<double, double> Population::GetBreedingStatistics() const
+    {
+        double breeding = 0.0;
+        double hidden = 0.0;
+        for (auto deme : Demes())
+        {
+            breeding += deme->m_breeding;
+            hidden += deme->m_hiddenBreeding;
+        }
+        return { breeding, hidden };
+    }
+
+    std::tuple<double, double, double> Population::GetOperatorRates() const
+    {
+        // islands adapt their rates independently, so report the average
+        auto demes = Demes();
+        double crossover = 0.0, mutation = 0.0, hoistMutation = 0.0;
+        for (auto deme : demes)
+        {
+            crossover += deme->m_rates.Probability(GeneticOperator::Crossover) / demes.size();
+            mutation += deme->m_rates.Probability(GeneticOperator::Mutation) / demes.size();
+            hoistMutation += deme->m_rates.Probability(GeneticOperator::HoistMutation) / demes.size();
+        }
+        return { crossover, mutation, hoistMutation };
+    }
+
+    const std::vector<Util::WorkStealingScheduler::WorkerStatistics>& Population::GetWorkerStatistics() const
+    {
+        return m_scheduler->Statistics();
+    }
+
+    void Population::RunBatch(const std::vector<double>& costs, const std::function<void(int, Worker&)>& task)
+    {
+        if (auto rows = RowsFor(m_params.PopulationSize))
+        {
+            auto& worker = m_workers[0];
+            worker.Rows = rows;
+            for (auto i = 0u; i < costs.size(); ++i)
+            {
+                task(i, worker);
+            }
+            worker.Rows = nullptr;
+            return;
+        }
+        m_scheduler->Run(costs, [&](int i, int w) { task(i, m_workers[w]); });
+    }
+
+    const RowPartition* Population::RowsFor(int individuals) const
+    {
+        // geometric semantic individuals are evaluated from their semantics, without any S-expression
+        if (m_rowPartition->Threads() <= 1 || m_params.Type == ChromosomeType::GeometricSemantic)
+        {
+            return nullptr;
+        }
+        auto rows = FitnessCaseRows();
+        bool split = rows >= MinRowsPerThread * m_rowPartition->Threads() && rows >= individuals;
+        return split ? m_rowPartition.get() : nullptr;
+    }
+
+    int Population::FitnessCaseRows() const
+    {
+        if (m_params.Type == ChromosomeType::TimeSeries)
+        {
+            return static_cast<int>(m_fitnessCases->size() - m_terminals->size()); // the terminals are the lags
+        }
+        return static_cast<int>(m_fitnessCases->size() / (m_terminals->size() + 1)); // incl dependent variable
+    }
+
+    double Population::EstimateCost(double treeCost) const
+    {
+        return treeCost * FitnessCaseRows();
     }
 
     double Population::UpdateParsimonyCoefficient()
@@ -269,38 +939,40 @@ namespace Model
             return m_params.ParsimonyCoefficient.value();
         }
 
-        using Itr = std::vector<Population::ChromoPtr>::iterator;
+        using Itr = std::vector<double>::const_iterator;
         const double DenominatorThreshold = 1e-06;
 
-        auto getSize = [](const Itr& itr) -> double { return static_cast<double>((*itr)->Size()); };
-        auto getFitness = [](const Itr& itr) -> double { return (*itr)->Fitness(); };
-        
-        auto varSize = Util::Variance<Itr>(m_population.begin(), m_population.end(), getSize);
-        auto covar = Util::Covariance<Itr, Itr>( m_population.begin(), m_population.end(), getSize,
-                                            m_population.begin(), m_population.end(), getFitness);
+        // the penalty is on cost, which is the size unless primitives are costed
+        const auto& costs = m_population.Costs();
+        const auto& fitness = m_population.Fitness();
+        auto varCost = Util::Variance<Itr>(costs.begin(), costs.end());
+        auto covar = Util::Covariance<Itr, Itr>(costs.begin(), costs.end(), [](Itr itr) { return *itr; },
+                                                fitness.begin(), fitness.end(), [](Itr itr) { return *itr; });
 
         // TODO: Revisit the paper documenting this method. It may be affected by allowing > 2 children
         // per node, or the type of fitness error/value being evaluated.
         if (covar < DenominatorThreshold)
         {
-            if (varSize < DenominatorThreshold)
+            if (varCost < DenominatorThreshold)
             {
                 return 0.0; // approaching 0/0
             }
             return 1.0; // approaching infty
         }
-        return covar / varSize;
+        return covar / varCost;
     }
 
     double Population::Forecast(double* predictions, int length)
     {
-        m_population[0]->Forecast(m_fitnessCases, m_terminals, &predictions[0], length);
-        return m_population[0]->Fitness();
+        const auto& best = Fittest();
+        best.Forecast(*m_fitnessCases, *m_terminals, &predictions[0], length);
+        return best.Fitness();
     }
 
     double Population::Predict(std::vector<double>& fitted, int cutoff)
     {
-        m_population[0]->Predict(fitted, m_terminals, cutoff);
-        return m_population[0]->Fitness();
+        const auto& best = Fittest();
+        best.Predict(fitted, *m_terminals, cutoff, RowsFor(1));
+        return best.Fitness();
     }
 }
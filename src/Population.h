@@ -1,13 +1,25 @@
 #ifndef Population_H
 #define Population_H
 
+#include <functional>
 #include <memory>
+#include <optional>
 #include <tuple>
 #include <vector>
+#include "model/ChromosomeFactory.h"
+#include "model/CostTable.h"
 #include "model/IChromosome.h"
+#include "model/MutationTable.h"
+#include "model/RowPartition.h"
+#include "model/TreeLimits.h"
+#include "OperatorRates.h"
 #include "PopulationParams.h"
+#include "PopulationStore.h"
+#include "SteadyStateStore.h"
 #include "utils/UniformRandomGenerator.h"
 #include "utils/ISelector.h"
+#include "utils/Mailbox.h"
+#include "utils/WorkStealingScheduler.h"
 
 namespace Tests
 {
@@ -39,7 +51,29 @@ namespace Model
         void Reset();
 
         /**
-         * Replace the entire population with it's direct descendants.
+         * Creates independent populations over the same fitness cases, which may each be reset and evolved on 
+         * its own thread at the same time as the others. They share this population's fitness cases, terminals and
+         * chromosome factory, so mustn't outlive it, and it mustn't be reset while they are in use.
+         * @param params The parameters of each replica, which may differ from this population's in any but those
+         *        the chromosome factory is built from (Type, MinInitialTreeSize, Initialisation, AllowedFunctions,
+         *        IntervalAnalysis, LinearScaling and the costs). Replicas aren't split into islands.
+         * @return the replicas, which haven't been reset
+         */
+        std::vector<std::unique_ptr<Population>> Replicate(const std::vector<PopulationParams>& params);
+
+        /**
+         * Replace the entire population with it's direct descendants. Families are bred and evaluated across
+         * the worker threads, largest first. Each family has its own random numbers, so the result doesn't 
+         * depend on which worker breeds it.
+         *
+         * If the population is split into islands, each island evolves on one worker thread instead, and
+         * every MigrationInterval generations sends its fittest individuals to other islands.
+         *
+         * If pipelined, workers that run out of evaluations breed the first families of the next generation
+         * (see PopulationParams::PipelineLag).
+         *
+         * If the population is steady-state, as many offspring as there are individuals are bred and inserted
+         * instead, with no barrier between them.
          */
         void Evolve();
 
@@ -79,7 +113,158 @@ namespace Model
          */
         double Predict(std::vector<double>& fitted, int cutoff = 0);
 
+        /**
+         * @return the number of offspring culled by Tarpeian bloat control since the last Reset, and the 
+         * total size of their S-expressions (i.e. the node evaluations saved per fitness case)
+         */
+        std::tuple<long, long> GetCullingStatistics() const;
+
+        /**
+         * @return the current probabilities of crossover, mutation and hoist mutation
+         */
+        std::tuple<double, double, double> GetOperatorRates() const;
+
+        /**
+         * @return the time spent breeding offspring since the last Reset, and how much of it was hidden by
+         *         pipelining (breeding ahead while other workers were still evaluating), in seconds
+         */
+        std::tuple<double, double> GetBreedingStatistics() const;
+
+        /**
+         * @return how each worker thread has been used since the last Reset, by worker index. Individuals
+         *         evaluated by splitting their fitness cases across the threads aren't counted.
+         */
+        const std::vector<Util::WorkStealingScheduler::WorkerStatistics>& GetWorkerStatistics() const;
+
     private:
+        /**
+         * The state that a worker thread breeds and evaluates offspring with, so that workers share 
+         * nothing mutable
+         */
+        struct Worker
+        {
+            std::vector<double> Terminals; ///< The terminal values the worker evaluates S-expressions with
+            Util::UniformRandomGenerator<float> RandomProbability{ 0.f, 1.f }; ///< Generates random floats in the range [0,1]
+            OperatorRates Tally; ///< The credit due to each operator for the worker's offspring
+            long Culled = 0; ///< The number of the worker's offspring culled by Tarpeian bloat control
+            long CulledNodes = 0; ///< The total size of the S-expressions of those offspring
+            double Breeding = 0.0; ///< The time spent breeding the worker's offspring, in seconds
+            const RowPartition* Rows = nullptr; ///< If set, the worker splits each evaluation across its threads
+        };
+
+        static const int MinRowsPerThread = 8192; ///< The fewest fitness cases per thread worth splitting an individual's
+
+        /**
+         * Runs a batch of evaluation tasks, either across the workers or, if the fitness cases are many enough
+         * to be worth splitting instead, one by one on worker 0 with its rows split across every thread
+         * @param costs The estimated cost of each task
+         * @param task Called once per task, with the index of the task and the state of the worker running it
+         */
+        void RunBatch(const std::vector<double>& costs, const std::function<void(int task, Worker& worker)>& task);
+
+        /**
+         * Chooses between evaluating individuals in parallel and splitting the fitness cases of each individual
+         * across threads. Rows are split if each thread would get at least MinRowsPerThread of them, and there
+         * are at least as many rows as individuals, since then each individual is costly enough to be worth
+         * the synchronisation, and evaluating them whole would balance poorly across the threads.
+         * @param individuals The number of individuals to evaluate together
+         * @return the row partition to evaluate each individual with, or nullptr to evaluate them whole
+         */
+        const RowPartition* RowsFor(int individuals) const;
+
+        /**
+         * @return the number of fitness cases
+         */
+        int FitnessCaseRows() const;
+
+        /**
+         * An individual sent from one island to another
+         */
+        struct Migrant
+        {
+            ChromoPtr Individual; ///< A copy of the individual
+            int Island; ///< The index of the island it was sent from
+            int Rank; ///< Its rank by weighted fitness on that island, where 0 is the fittest
+        };
+
+        /**
+         * Constructor
+         * @param fitnessCases The training cases, which are shared with any islands
+         * @param terminals The terminal values that S-expressions point to, which are shared with any islands
+         * @param mainland The population that this is an island or replica of, or nullptr if it's neither. Islands
+         *        and replicas don't have a chromosome factory of their own, since they share the mainland's data.
+         */
+        Population(const PopulationParams& params, std::shared_ptr<const std::vector<double>> fitnessCases, 
+                std::shared_ptr<std::vector<double>> terminals, const Population* mainland);
+
+        /**
+         * Creates the chromosome factory for this population's data, for it and its islands or replicas
+         */
+        void InitialiseFactory();
+
+        /**
+         * @return the chromosome factory, which islands and replicas share with their mainland
+         */
+        const ChromosomeFactory& Factory() const;
+
+        /**
+         * Resets each island, across the worker threads
+         */
+        void ResetIslands();
+
+        /**
+         * Evolves each island by a generation, across the worker threads, and migrates between them.
+         * Migrants are posted to mailboxes that alternate by generation, and each island takes in the migrants
+         * of the last generation at the start of its next one, so the result doesn't depend on timing.
+         */
+        void EvolveIslands();
+
+        /**
+         * Breeds as many offspring as there are individuals across the worker threads. Each worker selects parents
+         * from and inserts the survivors of each family into the population as it goes, without waiting for the
+         * other workers.
+         */
+        void EvolveSteadyState();
+
+        /**
+         * Picks a slot of a steady-state population, by tournament (or by comparing every slot, for the least 
+         * fit if ReplaceWorst is set)
+         * @param fittest If true, picks the fittest contestant, otherwise the least fit
+         * @return the slot, and the chromosome it held when compared
+         */
+        std::tuple<int, const IChromosome*> Contest(const SteadyStateStore& store, bool fittest) const;
+
+        /**
+         * Inserts an offspring into a steady-state population in place of a loser, if it is fitter than the loser
+         */
+        void Insert(SteadyStateStore& store, ChromoPtr child) const;
+
+        /**
+         * Adds the workers' operator credit and culling counts to the population's, and clears them
+         */
+        void CollectWorkerTallies();
+
+        /**
+         * @return the islands each island sends its migrants to, by island index
+         */
+        std::vector<std::vector<int>> MigrationDestinations();
+
+        /**
+         * Replaces the least fit individuals with the fittest Migrants immigrants, then recalibrates the selector
+         * @param immigrants The migrants sent to this island, in any order
+         */
+        void Immigrate(std::vector<Migrant> immigrants);
+
+        /**
+         * @return the islands, or this population alone if it isn't split into islands
+         */
+        std::vector<const Population*> Demes() const;
+
+        /**
+         * @return the individual with the best weighted fitness on any island
+         */
+        const IChromosome& Fittest() const;
+
         /**
          * Prepares the selector, such that appropriate parents may be selected
          * Called after a new generation/population has been created.
@@ -87,8 +272,12 @@ namespace Model
         void RecalibrateParentSelector();
 
         /**
-         * Sorts the m_population by WeightedFitness, and sorts a pointers to the Chromosomes in the population
-         * in order of Fitness.
+         * Tunes the constants of the TunedElites fittest chromosomes, replacing any that improve.
+         */
+        void TuneElites();
+
+        /**
+         * Orders the Chromosomes in m_population by WeightedFitness, and by Fitness.
          */
         void SortPopulation();
 
@@ -97,39 +286,110 @@ namespace Model
          * likely it will be selected as a parent.
          * @return a pointer to two parents
          */
-        std::tuple<IChromosome*, IChromosome*> SelectParents();
+        std::tuple<const IChromosome*, const IChromosome*> SelectParents() const;
+
+        /**
+         * The offspring of a pair of parents, bred but not yet evaluated
+         */
+        struct BredFamily
+        {
+            std::vector<ChromoPtr> Offspring; ///< The offspring, which haven't been evaluated
+            double ParentFitness = 0.0; ///< The fitness of the fitter parent, which offspring must beat to improve upon
+        };
 
         /**
-         * Adds two offspring from mum and dad to the nextGeneration
+         * Breeds TwinsPerMatingPair pairs of offspring from mum and dad as one family, and keeps the best two
          * @param mum The mother chromosome 
          * @param dad The father chromosome
-         * @param nextGeneration The next generation of chromosomes (that will replace current generation)
+         * @param worker The state of the calling worker thread
+         * @return the two survivors, for the next generation
+         */
+        std::vector<ChromoPtr> Reproduce(const IChromosome& mum, const IChromosome& dad, Worker& worker) const;
+
+        /**
+         * Breeds TwinsPerMatingPair pairs of offspring from mum and dad as one family, without evaluating them
+         * @param worker The state of the calling worker thread
+         * @return the family, which doesn't refer to its parents
          */
-        void Reproduce(const IChromosome& mum, const IChromosome& dad, std::vector<ChromoPtr>& nextGeneration);
+        BredFamily BreedFamily(const IChromosome& mum, const IChromosome& dad, Worker& worker) const;
 
         /**
-         * Deep copy from parents, perform crossover and mutation 
-         * @return Two offsprint S-expressions
+         * Evaluates a family, and keeps the best two
+         * @param family The family, which is consumed
+         * @param worker The state of the calling worker thread
+         * @return the two survivors, for the next generation
+         */
+        std::vector<ChromoPtr> EvaluateFamily(BredFamily family, Worker& worker) const;
+
+        /**
+         * Deep copy from parents, perform crossover and mutation, then evaluate any offspring that changed
+         * @param worker The state of the calling worker thread
+         * @param cutoff The weighted fitness an offspring must beat to survive. Offspring that can't
+         *        are not fully evaluated.
+         * @return Two offspring S-expressions
          */
         std::tuple<ChromoPtr, ChromoPtr> GetNewOffspring(const IChromosome& mum, const IChromosome& dad,
-                const std::vector<double>& fitnessCases, std::vector<double>& terminals, 
-                double parsimonyCoefficient) const;
+                Worker& worker, double parsimonyCoefficient, double cutoff) const;
+
+        /**
+         * Deep copy from parents, then perform crossover and mutation
+         * @param worker The state of the calling worker thread
+         * @return Two offspring, which have not been evaluated
+         */
+        std::tuple<ChromoPtr, ChromoPtr> Breed(const IChromosome& mum, const IChromosome& dad, Worker& worker) const;
+
+        /**
+         * Evaluates an offspring, unless it is an unmodified copy of its parent or is culled to control bloat,
+         * and credits the operators that modified it
+         * @param child The offspring, which is consumed
+         * @param worker The state of the calling worker thread
+         * @param parsimonyCoefficient The coefficient used to penalise long chromosomes
+         * @param cutoff The weighted fitness the offspring must beat to survive
+         * @param parentFitness The fitness of the fitter parent, which the offspring must beat to improve upon
+         * @return the evaluated offspring
+         */
+        ChromoPtr Evaluate(ChromoPtr child, Worker& worker, double parsimonyCoefficient, double cutoff, 
+                double parentFitness) const;
+
+        /**
+         * @return the estimated cost of evaluating an S-expression over every fitness case, for scheduling
+         * @param treeCost The cost of the S-expression, which is its size unless primitives are costed
+         */
+        double EstimateCost(double treeCost) const;
 
         /**
          * Updates the parsimony coefficient
          */
         double UpdateParsimonyCoefficient();
 
-        std::vector<ChromoPtr> m_population; ///< The chromosome population
-        std::vector<IChromosome*> m_sortedByFitness; ///< Pointers to the chromosome population, sorted by fitness
+        PopulationStore m_population; ///< The chromosome population
         PopulationParams m_params; ///< The parameters of the population
-        mutable Util::UniformRandomGenerator<float> m_randomProbability; ///< Generates random floats in the range [0,1]
         std::vector<double*> m_allowedTerminals; ///< The set of variables
+        std::vector<double*> m_terminalSet; ///< The set of variables, and nullptr for an ephemeral random constant
+        MutationTable m_mutations; ///< The functions and terminals that genes may mutate to
         std::unique_ptr<Util::ISelector<double>> m_selector; ///< Ticketing system used to select parents
+        std::unique_ptr<const ChromosomeFactory> m_factory; ///< Creates and evaluates chromosomes, unless an island or replica
 
-        std::vector<double> m_terminals; ///< The terminal values to evaluate
-        std::vector<double> m_fitnessCases; ///< Training cases
+        std::shared_ptr<std::vector<double>> m_terminals; ///< The terminal values to evaluate
+        std::shared_ptr<const std::vector<double>> m_fitnessCases; ///< Training cases
         double m_parsimonyCoefficient = 0.0; ///< The coefficient used to penalize long S-expressions.
+        TreeLimits m_limits; ///< The limits on the depth and size of offspring
+        std::optional<CostTable> m_costs; ///< The cost of each primitive, if S-expressions are penalised by cost
+        double m_averageSize = 0.0; ///< The average size of the S-expressions in the population
+        long m_culled = 0; ///< The number of offspring culled by Tarpeian bloat control
+        long m_culledNodes = 0; ///< The total size of the S-expressions of culled offspring
+        OperatorRates m_rates; ///< The probability of each genetic operator, and the credit due to each
+        Util::UniformRandomGenerator<int, std::uniform_int_distribution<int>> m_randomSeed; ///< Seeds each family's random numbers
+        std::vector<Worker> m_workers; ///< The state of each worker thread, by index
+        std::unique_ptr<Util::WorkStealingScheduler> m_scheduler; ///< Runs evaluations across the worker threads
+        std::unique_ptr<RowPartition> m_rowPartition; ///< Splits the fitness cases across the worker threads
+        const Population* m_mainland = nullptr; ///< The population this is an island or replica of, or nullptr
+        std::vector<std::unique_ptr<Population>> m_islands; ///< The islands the population is split into, if any
+        std::vector<Util::Mailbox<Migrant>> m_mailboxes; ///< The migrants sent to each island, in generations of even then odd parity
+        int m_generation = 0; ///< The number of generations evolved since the last Reset
+        std::vector<BredFamily> m_bredAhead; ///< The first families of the next generation, if pipelined
+        double m_breeding = 0.0; ///< The time spent breeding offspring since the last Reset, in seconds
+        double m_hiddenBreeding = 0.0; ///< The time spent breeding ahead while other workers were still evaluating, in seconds
     };
 }
 
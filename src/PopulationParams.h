@@ -1,9 +1,14 @@
 #ifndef PopulationParams_h
 #define PopulationParams_h
 
+#include <map>
 #include <optional>
+#include <string>
 #include <vector>
 #include "model/ChromosomeType.h"
+#include "model/InitialisationMethod.h"
+#include "model/MigrationTopology.h"
+#include "model/SweptParameter.h"
 
 namespace Model
 {
@@ -48,6 +53,159 @@ namespace Model
          * If set to std::nullopt, the coefficient will be approximated dynamically.
          */
         std::optional<double> ParsimonyCoefficient; ///< 
+
+        /**
+         * If true, S-expressions are bounded by interval arithmetic over the range of the fitness cases
+         * before evaluation. Provably constant subtrees are replaced by constants, and S-expressions that 
+         * are provably non-finite for every fitness case are given the worst fitness without evaluation.
+         */
+        bool IntervalAnalysis = true;
+
+        /**
+         * If true, the output of each (Normal) S-expression is scaled by the least-squares slope and intercept
+         * against the expected values, so evolution need only find the shape of the target function rather 
+         * than its scale and offset. Fitness is then the RMSE of the scaled output.
+         */
+        bool LinearScaling = false;
+
+        /**
+         * If true, ephemeral random constants are added to the terminal set. Each is assigned a random
+         * value upon creation, which is fixed thereafter (other than by TunedElites).
+         */
+        bool EphemeralConstants = false;
+
+        /**
+         * The number of the fittest (Normal) S-expressions whose constants are tuned to the fitness cases
+         * each generation, by Levenberg-Marquardt. If set to 0, constants are never tuned.
+         */
+        int TunedElites = 0;
+
+        /**
+         * How the random S-expressions of the initial population are created. MinInitialTreeSize is the
+         * target size for every S-expression, or the smallest of the ramped target sizes.
+         */
+        InitialisationMethod Initialisation = InitialisationMethod::Grow;
+
+        /**
+         * The maximum depth of S-expressions produced by crossover, where the root is at depth 0. 
+         * Unlimited if 0.
+         */
+        int MaxTreeDepth = 0;
+
+        /**
+         * The maximum size of S-expressions produced by crossover. Unlimited if 0.
+         */
+        int MaxTreeSize = 0;
+
+        /**
+         * The number of times crossover may pick new points when the offspring would exceed MaxTreeDepth
+         * or MaxTreeSize, before the crossover is rejected (and the offspring are copies of their parents).
+         */
+        int BloatRetries = 3;
+
+        /**
+         * The proportion of offspring larger than the average S-expression in the population that are
+         * given the worst fitness without evaluation (Tarpeian bloat control). If set to 0, none are.
+         */
+        double TarpeianRate = 0.0;
+
+        /**
+         * The number of worker threads. If set to 0, one per hardware thread is used. Results are only
+         * deterministic (for a given Seed) with the same number of threads.
+         */
+        int Threads = 0;
+
+        /**
+         * If true, the parsimony coefficient penalises the estimated cost of evaluating each S-expression,
+         * rather than its size, so that expensive functions (e.g. exp, sin, ln) are penalised more than 
+         * cheap ones (e.g. +). Costs are in units of the cost of an addition.
+         */
+        bool CostParsimony = false;
+
+        /**
+         * The cost of each function, when CostParsimony is set. Unlisted functions cost 1, as do terminals.
+         * If empty, the costs are measured by a microbenchmark when the population is constructed.
+         */
+        std::map<FunctionType, double> PrimitiveCosts;
+
+        /**
+         * If true, CrossoverProb, MutationProb and HoistMutationProb are only the initial probabilities of 
+         * each operator. Each generation, they are adapted towards the operator that most often produced 
+         * offspring fitter than their parents (by adaptive pursuit).
+         */
+        bool AdaptiveOperators = false;
+
+        double MinOperatorProb = 0.01; ///< The lower bound of each adaptive operator probability
+        double MaxOperatorProb = 0.9; ///< The upper bound of each adaptive operator probability
+        double OperatorAdaptationRate = 0.3; ///< How quickly adaptive operator probabilities respond, in [0,1]
+
+        /**
+         * The step by which geometric semantic mutation perturbs the output of an S-expression, when Type 
+         * is GeometricSemantic.
+         */
+        double GeometricMutationStep = 0.1;
+
+        /**
+         * The number of islands the population is split into. Each island evolves on one thread, with its own
+         * selector and random numbers, and shares nothing with the others but its migrants. If 1, the 
+         * population isn't split.
+         */
+        int Islands = 1;
+
+        int MigrationInterval = 10; ///< The number of generations between migrations. Islands never migrate if 0.
+        int Migrants = 2; ///< The number of its fittest individuals that each island sends each migration
+        MigrationTopology Topology = MigrationTopology::Ring; ///< Which islands each island sends its migrants to
+
+        /**
+         * If true, there are no generations: each worker thread repeatedly selects parents, breeds and evaluates
+         * their offspring, and inserts each survivor in place of a loser, without waiting for the other workers.
+         * An offspring only replaces a loser that it is fitter than. Each call to Evolve breeds as many offspring
+         * as there are individuals. Results are only deterministic (for a given Seed) with one thread.
+         */
+        bool SteadyState = false;
+
+        /**
+         * If true, steady-state offspring replace the least fit individual, found by comparing every individual.
+         * Otherwise they replace the loser of a tournament, which costs much less in large populations.
+         */
+        bool ReplaceWorst = false;
+
+        /**
+         * The proportion of each generation's families, in [0,1], to breed ahead: while the current generation is
+         * still being evaluated, workers that would otherwise wait for it breed (but don't evaluate) that many
+         * families of the next generation. The current generation hasn't been ranked by then, so these families
+         * select their parents from the one before it. That is, this proportion of the offspring lag a generation
+         * behind the rest, which weakens selection pressure slightly and mixes in a little more of the older
+         * generation's material. They're evaluated as part of the next generation, against its parsimony
+         * coefficient. Pipelining is off if 0, and doesn't apply to steady-state populations.
+         */
+        double PipelineLag = 0.0;
+    };
+
+    /**
+     * A search over some of the population parameters. Each configuration it yields is run over the same
+     * fitness cases, in place of the configured population parameters.
+     */
+    struct SweepSpec
+    {
+        /**
+         * A parameter that the sweep varies
+         */
+        struct Axis
+        {
+            SweptParameter Parameter; ///< The parameter
+            std::string Name; ///< The name of the parameter, as configured
+            std::vector<double> Values; ///< The values of a grid, or the bounds that a random search draws between
+        };
+
+        std::vector<Axis> Axes; ///< The parameters varied. If empty, there is no sweep.
+
+        /**
+         * If true, Samples configurations are drawn at random, each value uniformly between the least and greatest
+         * of its axis. Otherwise every combination of the values of the axes is run, varying the last fastest.
+         */
+        bool Random = false;
+        int Samples = 10; ///< The number of configurations drawn by a random search
     };
 
     /**
@@ -63,6 +221,7 @@ namespace Model
         PopulationParams Params{}; ///< Parameters for the population
         std::vector<double> FitnessCases; ///< Training cases
         int ForecastSteps = 0; ///< used for time series forcasting. Determines the number of steps forward to forecast.
+        SweepSpec Sweep{}; ///< The configurations to sweep, if any, instead of running the population parameters alone
     };
 }
 
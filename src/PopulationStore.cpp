@@ -0,0 +1,90 @@
+#include "PopulationStore.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+    /**
+     * Sets ids to the indices of the keys, in ascending order of key
+     */
+    void SortIds(const std::vector<double>& keys, std::vector<int>& ids)
+    {
+        // sort the keys alongside the IDs, so that comparisons read contiguous memory
+        std::vector<std::pair<double, int>> keyed(keys.size());
+        for (auto i = 0u; i < keys.size(); ++i)
+        {
+            keyed[i] = { keys[i], static_cast<int>(i) };
+        }
+        std::sort(keyed.begin(), keyed.end());
+
+        ids.resize(keys.size());
+        std::transform(keyed.begin(), keyed.end(), ids.begin(), [](const auto& k) { return k.second; });
+    }
+}
+
+namespace Model
+{
+    void PopulationStore::Clear()
+    {
+        m_chromosomes.clear();
+        m_fitness.clear();
+        m_weightedFitness.clear();
+        m_sizes.clear();
+        m_costs.clear();
+        m_byWeightedFitness.clear();
+        m_byFitness.clear();
+    }
+
+    void PopulationStore::Reserve(int size)
+    {
+        m_chromosomes.reserve(size);
+        m_fitness.reserve(size);
+        m_weightedFitness.reserve(size);
+        m_sizes.reserve(size);
+        m_costs.reserve(size);
+    }
+
+    int PopulationStore::Add(ChromoPtr chromosome)
+    {
+        m_fitness.push_back(chromosome->Fitness());
+        m_weightedFitness.push_back(chromosome->WeightedFitness());
+        m_sizes.push_back(chromosome->Size());
+        m_costs.push_back(chromosome->Cost());
+        m_chromosomes.push_back(std::move(chromosome));
+        return Size() - 1;
+    }
+
+    void PopulationStore::Replace(int id, ChromoPtr chromosome)
+    {
+        m_fitness[id] = chromosome->Fitness();
+        m_weightedFitness[id] = chromosome->WeightedFitness();
+        m_sizes[id] = chromosome->Size();
+        m_costs[id] = chromosome->Cost();
+        m_chromosomes[id] = std::move(chromosome);
+    }
+
+    void PopulationStore::Sort()
+    {
+        SortIds(m_weightedFitness, m_byWeightedFitness);
+        SortIds(m_fitness, m_byFitness);
+    }
+
+    void PopulationStore::Swap(PopulationStore& other)
+    {
+        m_chromosomes.swap(other.m_chromosomes);
+        m_fitness.swap(other.m_fitness);
+        m_weightedFitness.swap(other.m_weightedFitness);
+        m_sizes.swap(other.m_sizes);
+        m_costs.swap(other.m_costs);
+        m_byWeightedFitness.swap(other.m_byWeightedFitness);
+        m_byFitness.swap(other.m_byFitness);
+    }
+
+    std::vector<PopulationStore::ChromoPtr> PopulationStore::Release()
+    {
+        auto chromosomes = std::move(m_chromosomes);
+        Clear();
+        return chromosomes;
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef PopulationStore_H
+#define PopulationStore_H
+
+#include <memory>
+#include <vector>
+#include "model/IChromosome.h"
+
+namespace Model
+{
+    /**
+     * Stores the chromosomes of a population, indexed by ID in the order they were added.
+     *
+     * The fitness, weighted fitness, size and cost of each chromosome are mirrored in parallel arrays,
+     * so that sorting, selection and statistics run over dense arrays of numbers rather than
+     * dereferencing each chromosome. Sorting reorders only the IDs, never the chromosomes.
+     */
+    class PopulationStore
+    {
+    public:
+        using ChromoPtr = std::unique_ptr<IChromosome>;
+
+        /**
+         * Removes every chromosome
+         */
+        void Clear();
+
+        /**
+         * Reserves space for a number of chromosomes
+         */
+        void Reserve(int size);
+
+        /**
+         * Adds a chromosome to the store. The store is no longer sorted.
+         * @return the ID of the chromosome
+         */
+        int Add(ChromoPtr chromosome);
+
+        /**
+         * Replaces the chromosome with the given ID. The store is no longer sorted.
+         */
+        void Replace(int id, ChromoPtr chromosome);
+
+        /**
+         * @return the number of chromosomes
+         */
+        int Size() const { return static_cast<int>(m_chromosomes.size()); }
+
+        /**
+         * @return true if there are no chromosomes
+         */
+        bool Empty() const { return m_chromosomes.empty(); }
+
+        /**
+         * @return the chromosome with the given ID
+         */
+        const IChromosome& operator[](int id) const { return *m_chromosomes[id]; }
+
+        /**
+         * @return the fitness of each chromosome, by ID
+         */
+        const std::vector<double>& Fitness() const { return m_fitness; }
+
+        /**
+         * @return the weighted fitness of each chromosome, by ID
+         */
+        const std::vector<double>& WeightedFitness() const { return m_weightedFitness; }
+
+        /**
+         * @return the size of each chromosome, by ID
+         */
+        const std::vector<double>& Sizes() const { return m_sizes; }
+
+        /**
+         * @return the estimated evaluation cost of each chromosome, by ID
+         */
+        const std::vector<double>& Costs() const { return m_costs; }
+
+        /**
+         * Orders the IDs by weighted fitness, and by fitness
+         */
+        void Sort();
+
+        /**
+         * @return the IDs of the chromosomes, from best to worst weighted fitness
+         * @pre Sort has been called since the store last changed
+         */
+        const std::vector<int>& ByWeightedFitness() const { return m_byWeightedFitness; }
+
+        /**
+         * @return the IDs of the chromosomes, from best to worst fitness
+         * @pre Sort has been called since the store last changed
+         */
+        const std::vector<int>& ByFitness() const { return m_byFitness; }
+
+        /**
+         * Exchanges the contents of two stores
+         */
+        void Swap(PopulationStore& other);
+
+        /**
+         * Removes every chromosome
+         * @return the chromosomes, by ID
+         */
+        std::vector<ChromoPtr> Release();
+
+    private:
+        std::vector<ChromoPtr> m_chromosomes; ///< The chromosomes, by ID
+        std::vector<double> m_fitness; ///< The fitness of each chromosome, by ID
+        std::vector<double> m_weightedFitness; ///< The weighted fitness of each chromosome, by ID
+        std::vector<double> m_sizes; ///< The size of each chromosome, by ID
+        std::vector<double> m_costs; ///< The estimated evaluation cost of each chromosome, by ID
+        std::vector<int> m_byWeightedFitness; ///< IDs, from best to worst weighted fitness
+        std::vector<int> m_byFitness; ///< IDs, from best to worst fitness
+    };
+}
+
+#endif
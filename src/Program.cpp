@@ -1,10 +1,82 @@
 #include "Program.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
 #include "ConfigParser.h"
 #include "model/FunctionFactory.h"
+#include "utils/UniformRandomGenerator.h"
+#include "utils/WorkStealingScheduler.h"
+
+namespace
+{
+    /**
+     * Sets a swept parameter, rounding it if it's an integer
+     */
+    void SetSweptValue(Model::PopulationParams& params, Model::SweptParameter parameter, double value)
+    {
+        switch (parameter)
+        {
+        case Model::SweptParameter::PopulationSize:
+            params.PopulationSize = static_cast<int>(std::lround(value));
+            break;
+        case Model::SweptParameter::TwinsPerMatingPair:
+            params.TwinsPerMatingPair = static_cast<int>(std::lround(value));
+            break;
+        case Model::SweptParameter::CarryOverProportion:
+            params.CarryOverProportion = value;
+            break;
+        case Model::SweptParameter::ParsimonyCoefficient:
+            params.ParsimonyCoefficient = value;
+            break;
+        case Model::SweptParameter::CrossoverProb:
+            params.CrossoverProb = value;
+            break;
+        case Model::SweptParameter::MutationProb:
+            params.MutationProb = value;
+            break;
+        case Model::SweptParameter::HoistMutationProb:
+            params.HoistMutationProb = value;
+            break;
+        case Model::SweptParameter::TarpeianRate:
+            params.TarpeianRate = value;
+            break;
+        }
+    }
+
+    /**
+     * @return the value of a swept parameter
+     */
+    double SweptValue(const Model::PopulationParams& params, Model::SweptParameter parameter)
+    {
+        switch (parameter)
+        {
+        case Model::SweptParameter::PopulationSize:
+            return params.PopulationSize;
+        case Model::SweptParameter::TwinsPerMatingPair:
+            return params.TwinsPerMatingPair;
+        case Model::SweptParameter::CarryOverProportion:
+            return params.CarryOverProportion;
+        case Model::SweptParameter::ParsimonyCoefficient:
+            return params.ParsimonyCoefficient.value_or(0.0);
+        case Model::SweptParameter::CrossoverProb:
+            return params.CrossoverProb;
+        case Model::SweptParameter::MutationProb:
+            return params.MutationProb;
+        case Model::SweptParameter::HoistMutationProb:
+            return params.HoistMutationProb;
+        case Model::SweptParameter::TarpeianRate:
+        default:
+            return params.TarpeianRate;
+        }
+    }
+}
 
 namespace Model
 {
@@ -29,70 +101,332 @@ namespace Model
 
     void Program::Start(bool logResults)
     {
+        int threads = Threads();
+        if (m_iterations > 1 && threads > 1 && m_config.Params.Islands <= 1)
+        {
+            StartConcurrently(logResults, threads);
+            return;
+        }
+        m_lastReplica.reset();
+
         // Run the experiment m_iterations times
         for (int iteration = 0; iteration < m_iterations; ++iteration)
         {
             m_population->Reset(); // start with a fresh population
-            
-            double minimum;
             if (logResults)
             {
                 m_logger.SetFilename("output" + std::to_string(iteration));
-                // m_logger.WriteHeader("Average Fitness", "Best Fitness", "Best S-Expression"); // TODO
+            }
+
+            double minimum = Run(*m_population, logResults ? &m_logger : nullptr);
+            if (logResults)
+            {
+                Report(*m_population, iteration, minimum);
+            }
+        }
+        m_fitted = m_iterations > 0;
+
+        if (logResults)
+        {
+            m_logger.Write();
+            std::cout << "Results written to " << m_logger.GetOutputDir() << std::endl << std::endl;
+        }
+    }
+
+    void Program::StartConcurrently(bool logResults, int threads)
+    {
+        // each iteration is a replica of the population, with its own seed and a fair share of the threads
+        Util::UniformRandomGenerator<int, std::uniform_int_distribution<int>> seeds(0, std::numeric_limits<int>::max());
+        if (m_config.Params.Seed.has_value())
+        {
+            seeds.SetSeed(m_config.Params.Seed.value());
+        }
+        int concurrent = std::min(m_iterations, threads);
+        std::vector<PopulationParams> params(m_iterations, m_config.Params);
+        for (auto& replica : params)
+        {
+            replica.Seed = seeds.Get();
+            replica.Threads = std::max(1, threads / concurrent);
+        }
+        auto replicas = m_population->Replicate(params);
+
+        // iterations that stop early free their thread for the next, and each logs to its own stream
+        std::vector<GenerationLogger> loggers(m_iterations, GenerationLogger{""});
+        std::vector<double> minimums(m_iterations);
+        Util::WorkStealingScheduler scheduler(concurrent);
+        scheduler.Run(std::vector<double>(m_iterations, 1.0), [&](int i, int)
+        {
+            replicas[i]->Reset();
+            minimums[i] = Run(*replicas[i], logResults ? &loggers[i] : nullptr);
+        });
 
-                auto [ min, firstQtr, median, thirdQtr, max ] = m_population->GetRangeStatistics();
-                m_logger.AddLine(min, firstQtr, median, thirdQtr, max, "\"" + m_population->GetBestFit()->ToString() + "\"");
+        // then the results are merged in order, as if the iterations had run in turn
+        if (logResults)
+        {
+            for (int iteration = 0; iteration < m_iterations; ++iteration)
+            {
+                Report(*replicas[iteration], iteration, minimums[iteration]);
+                m_logger.Append(loggers[iteration]);
             }
+            m_logger.SetFilename("output" + std::to_string(m_iterations - 1));
+            m_logger.Write();
+            std::cout << "Results written to " << m_logger.GetOutputDir() << std::endl << std::endl;
+        }
+        m_lastReplica = std::move(replicas.back());
+        m_fitted = true;
+    }
+
+    bool Program::IsSweep() const
+    {
+        return !m_config.Sweep.Axes.empty();
+    }
+
+    std::vector<Program::SweepResult> Program::Sweep(bool logResults, const std::string& filename)
+    {
+        Util::UniformRandomGenerator<int, std::uniform_int_distribution<int>> seeds(0, std::numeric_limits<int>::max());
+        if (m_config.Params.Seed.has_value())
+        {
+            seeds.SetSeed(m_config.Params.Seed.value());
+        }
+        auto configurations = SweepConfigurations(seeds);
+        if (configurations.empty())
+        {
+            return {};
+        }
 
-            // evolve over m_numGenerations
-            for (auto i = 0; i < m_numGenerations; ++i)
+        // each configuration has its own seed and a fair share of the threads, and costs about as much to run
+        // as the offspring it breeds each generation
+        int threads = Threads();
+        int concurrent = std::min(static_cast<int>(configurations.size()), threads);
+        std::vector<double> costs;
+        for (auto& params : configurations)
+        {
+            params.Seed = seeds.Get();
+            params.Threads = std::max(1, threads / concurrent);
+            costs.push_back(static_cast<double>(params.PopulationSize) * params.TwinsPerMatingPair);
+        }
+        auto replicas = m_population->Replicate(configurations);
+
+        std::vector<SweepResult> results(configurations.size());
+        Util::WorkStealingScheduler scheduler(concurrent);
+        scheduler.Run(costs, [&](int i, int)
+        {
+            using Clock = std::chrono::steady_clock;
+            auto start = Clock::now();
+            auto& result = results[i];
+            result.Params = configurations[i];
+            for (int iteration = 0; iteration < m_iterations; ++iteration)
             {
-                m_population->Evolve();
+                replicas[i]->Reset();
+                result.BestFitness = std::min(result.BestFitness, Run(*replicas[i], nullptr));
+            }
+            std::chrono::duration<double> seconds = Clock::now() - start;
+            result.Seconds = seconds.count();
+        });
+        if (m_iterations <= 0)
+        {
+            return results; // no replica was reset, so there is nothing to predict with
+        }
 
-                if (logResults)
-                {
-                    auto [ min, firstQtr, median, thirdQtr, max ] = m_population->GetRangeStatistics();
-                    minimum = min;
+        // predictions are made by the best configuration, as of its last iteration
+        auto best = std::min_element(replicas.begin(), replicas.end(), [](const auto& a, const auto& b)
+        {
+            return a->GetBestFit()->Fitness() < b->GetBestFit()->Fitness();
+        });
+        m_lastReplica = std::move(*best);
+        m_fitted = true;
 
-                    m_logger.AddLine(minimum, firstQtr, median, thirdQtr, max, "\"" + m_population->GetBestFit()->ToString() + "\"");
-                }
-                else
+        if (logResults)
+        {
+            const auto& axes = m_config.Sweep.Axes;
+            std::ofstream out(filename);
+            std::cout << "Swept " << results.size() << " configurations:" << std::endl << std::setw(14) << "Configuration";
+            out << "Configuration";
+            for (const auto& axis : axes)
+            {
+                std::cout << std::setw(std::max<int>(12, axis.Name.size() + 2)) << axis.Name;
+                out << "," << axis.Name;
+            }
+            std::cout << std::setw(12) << "Seconds" << std::setw(16) << "Best fitness" << std::endl;
+            out << ",Seconds,BestFitness" << std::endl;
+
+            for (auto i = 0u; i < results.size(); ++i)
+            {
+                std::cout << std::setw(14) << i + 1;
+                out << i + 1;
+                for (const auto& axis : axes)
                 {
-                    minimum = m_population->GetBestFit()->Fitness();
+                    auto value = SweptValue(results[i].Params, axis.Parameter);
+                    std::cout << std::setw(std::max<int>(12, axis.Name.size() + 2)) << value;
+                    out << "," << value;
                 }
+                std::cout << std::fixed << std::setw(12) << results[i].Seconds << std::setw(16) << results[i].BestFitness 
+                    << std::defaultfloat << std::endl;
+                out << "," << results[i].Seconds << "," << results[i].BestFitness << std::endl;
+            }
+            std::cout << std::endl << "Results written to " << filename << std::endl << std::endl;
+        }
+        return results;
+    }
+
+    std::vector<PopulationParams> Program::SweepConfigurations(
+            Util::UniformRandomGenerator<int, std::uniform_int_distribution<int>>& seeds) const
+    {
+        const auto& sweep = m_config.Sweep;
+        std::vector<PopulationParams> configurations;
+        if (sweep.Axes.empty())
+        {
+            return configurations;
+        }
 
-                if (minimum < m_config.StoppingCriteria)
+        if (sweep.Random)
+        {
+            // each value is drawn uniformly between the least and greatest of its axis
+            Util::UniformRandomGenerator<double> random(0.0, 1.0);
+            random.SetSeed(seeds.Get());
+            for (int sample = 0; sample < sweep.Samples; ++sample)
+            {
+                auto params = m_config.Params;
+                for (const auto& axis : sweep.Axes)
                 {
-                    break;
+                    auto [least, greatest] = std::minmax_element(axis.Values.begin(), axis.Values.end());
+                    SetSweptValue(params, axis.Parameter, *least + random.Get() * (*greatest - *least));
                 }
+                configurations.push_back(params);
             }
+            return configurations;
+        }
 
-            if (logResults)
+        // every combination of the values, counting through the last axis fastest
+        std::vector<std::size_t> indices(sweep.Axes.size(), 0);
+        while (true)
+        {
+            auto params = m_config.Params;
+            for (auto a = 0u; a < sweep.Axes.size(); ++a)
             {
-                // print best result
-                std::cout << std::fixed << "Best S-expression in iteration " << iteration+1
-                    << " has fitness: " << minimum << std::endl
-                    << "\t" << m_population->GetBestFit()->ToString() << std::endl << std::endl;
+                SetSweptValue(params, sweep.Axes[a].Parameter, sweep.Axes[a].Values[indices[a]]);
+            }
+            configurations.push_back(params);
+
+            int axis = static_cast<int>(indices.size()) - 1;
+            while (axis >= 0 && ++indices[axis] == sweep.Axes[axis].Values.size())
+            {
+                indices[axis--] = 0;
+            }
+            if (axis < 0)
+            {
+                return configurations;
             }
         }
+    }
 
-        if (logResults)
+    int Program::Threads() const
+    {
+        return m_config.Params.Threads > 0 
+            ? m_config.Params.Threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    double Program::Run(Population& population, GenerationLogger* logger) const
+    {
+        double minimum = population.GetBestFit()->Fitness();
+        if (logger)
         {
-            m_logger.Write();
-            std::cout << "Results written to " << m_logger.GetOutputDir() << std::endl << std::endl;
+            // logger->WriteHeader("Average Fitness", "Best Fitness", "Best S-Expression"); // TODO
+
+            auto [ min, firstQtr, median, thirdQtr, max ] = population.GetRangeStatistics();
+            auto [ crossover, mutation, hoistMutation ] = population.GetOperatorRates();
+            logger->AddLine(min, firstQtr, median, thirdQtr, max, "\"" + population.GetBestFit()->Summary() + "\"",
+                    crossover, mutation, hoistMutation);
+        }
+
+        // evolve over m_numGenerations
+        for (auto i = 0; i < m_numGenerations; ++i)
+        {
+            population.Evolve();
+
+            if (logger)
+            {
+                auto [ min, firstQtr, median, thirdQtr, max ] = population.GetRangeStatistics();
+                auto [ crossover, mutation, hoistMutation ] = population.GetOperatorRates();
+                minimum = min;
+
+                logger->AddLine(minimum, firstQtr, median, thirdQtr, max, "\"" + population.GetBestFit()->Summary() + "\"",
+                        crossover, mutation, hoistMutation);
+            }
+            else
+            {
+                minimum = population.GetBestFit()->Fitness();
+            }
+
+            if (minimum < m_config.StoppingCriteria)
+            {
+                break;
+            }
+        }
+        return minimum;
+    }
+
+    void Program::Report(const Population& population, int iteration, double minimum) const
+    {
+        // print best result
+        std::cout << std::fixed << "Best S-expression in iteration " << iteration+1
+            << " has fitness: " << minimum << std::endl
+            << "\t" << population.GetBestFit()->ToString() << std::endl << std::endl;
+
+        if (m_config.Params.CostParsimony)
+        {
+            std::cout << "Its estimated evaluation cost is " << population.GetBestFit()->Cost()
+                << " additions" << std::endl << std::endl;
+        }
+
+        auto [ culled, culledNodes ] = population.GetCullingStatistics();
+        if (culled > 0)
+        {
+            std::cout << "Tarpeian bloat control culled " << culled << " offspring without evaluation, saving " 
+                << culledNodes << " node evaluations per fitness case" << std::endl << std::endl;
+        }
+
+        if (m_config.Params.PipelineLag > 0.0)
+        {
+            auto [ breeding, hidden ] = population.GetBreedingStatistics();
+            std::cout << "Pipelining hid " << std::setprecision(0) << 100.0 * (breeding > 0.0 ? hidden / breeding : 0.0) 
+                << "% of the time spent breeding" << std::setprecision(6) << " (" << hidden << " of " << breeding 
+                << " seconds)" << std::endl << std::endl;
+        }
+
+        const auto& workers = population.GetWorkerStatistics();
+        if (workers.size() > 1 && workers[0].Elapsed > 0.0) // unless rows were split instead
+        {
+            long stolen = 0;
+            std::cout << "Worker utilisation:" << std::setprecision(0);
+            for (const auto& worker : workers)
+            {
+                std::cout << " " << 100.0 * worker.Utilisation() << "%";
+                stolen += worker.Stolen;
+            }
+            std::cout << std::setprecision(6) << " (" << stolen << " tasks stolen)" << std::endl << std::endl;
+        }
+    }
+
+    Population& Program::Fitted()
+    {
+        if (!m_fitted)
+        {
+            throw std::logic_error("No population has been fitted yet. Call Start or Sweep first.");
         }
+        return m_lastReplica ? *m_lastReplica : *m_population;
     }
 
     double Program::Forecast(double* predictions, int length)
     {
-        m_population->Forecast(predictions, length);
-        return m_population->GetBestFit()->Fitness();
+        Fitted().Forecast(predictions, length);
+        return Fitted().GetBestFit()->Fitness();
     }
 
     double Program::Predict(std::vector<double>& fitted, int cutoff)
     {
-        m_population->Predict(fitted, cutoff);
-        return m_population->GetBestFit()->Fitness();
+        Fitted().Predict(fitted, cutoff);
+        return Fitted().GetBestFit()->Fitness();
     }
 
     double Program::Predict(const std::string& filename)
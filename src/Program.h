@@ -1,11 +1,14 @@
 #ifndef Program_H
 #define Program_H
 
+#include <limits>
 #include <memory>
+#include <string>
 #include <vector>
 #include "PopulationParams.h"
 #include "Population.h"
 #include "utils/Logger.h"
+#include "utils/UniformRandomGenerator.h"
 
 namespace Model
 {
@@ -16,6 +19,16 @@ namespace Model
     class Program
     {
     public:
+        /**
+         * The outcome of one configuration of a sweep
+         */
+        struct SweepResult
+        {
+            PopulationParams Params; ///< The configuration
+            double Seconds = 0.0; ///< The wall time taken by its iterations
+            double BestFitness = std::numeric_limits<double>::max(); ///< The best fitness of any of its iterations
+        };
+
         /**
          * Constructor
          */
@@ -28,16 +41,40 @@ namespace Model
         Program(const Config& config);
 
         /**
-         * Runs the genetic program for the specified number of generations
+         * Runs the genetic program for the specified number of generations, once per iteration.
+         *
+         * Iterations share nothing but the fitness cases, so if there are several and more than one thread,
+         * they run side by side as replicas of the population, each with its own seed (derived from the 
+         * configured one, if any) and log. Their results are reported in order once all have finished, and the 
+         * last iteration's population is kept for forecasts and predictions, as when they run in turn. 
+         * Populations split into islands already spread each iteration across the threads, so run in turn.
          */
         void Start(bool logResults = true);
 
+        /**
+         * @return whether the config specifies a sweep, to run instead of Start
+         */
+        bool IsSweep() const;
+
+        /**
+         * Runs each configuration of the configured sweep for the specified number of iterations and generations.
+         * Configurations are replicas of the population, which share its fitness cases read-only, so the data is
+         * loaded once. They run side by side across the threads, largest first, each with its own seed (derived
+         * from the configured one, if any). Configurations aren't split into islands.
+         * @param logResults If true, prints a table of the results, and writes it to filename as CSV
+         * @param filename The file to write the table to
+         * @post Forecast and Predict use the population of the best configuration, as of its last iteration,
+         *       unless there are no iterations
+         * @return the result of each configuration, in the order of the sweep
+         */
+        std::vector<SweepResult> Sweep(bool logResults = true, const std::string& filename = "Sweep.csv");
+
         /**
          * Provides forecast data based on the best fit Program/Chromosome.
          * @param predictions The double array to write forecasts into.
          * @param length The length of the data array (and therefore the number of predictions to make)
          * @return The standard error of the fit chromosome.
-         * @pre Start must be called prior to Forecast.
+         * @pre Start or Sweep must be called prior to Forecast.
          * @return the standard error of the residuals for the best Chromosome
          */
         double Forecast(double* predictions, int length);
@@ -51,7 +88,7 @@ namespace Model
          * @param fitted The data to fit the model to.
          * @param cutoff Used for TimeSeries data to specify where known values end. For example, cutoff=128
          * indicates there are 128 know values, and we want to predict (predictionCases-cutoff) steps ahead.
-         * @pre Start must be called prior to Forecast.
+         * @pre Start or Sweep must be called prior to Forecast.
          * @return the standard error of the residuals for the best Chromosome
          */
         double Predict(std::vector<double>& fitted, int cutoff = 0);
@@ -59,17 +96,61 @@ namespace Model
         /**
          * Overload of Predict that writes results of the prediction to a csv file.
          * @param filename The file to write to.
-         * @pre Start must be called prior to Forecast.
+         * @pre Start or Sweep must be called prior to Forecast.
          * @return the standard error of the residuals for the best Chromosome
          */
         double Predict(const std::string& filename = "Predictions.csv");
 
     private:
+        // fitness statistics, best S-expression, and crossover, mutation and hoist mutation probabilities by generation
+        using GenerationLogger = Util::Logger<double, double, double, double, double, std::string, double, double, double>;
+
+        /**
+         * Runs the iterations side by side, each as a replica of the population
+         * @param threads The number of threads to share between the iterations
+         */
+        void StartConcurrently(bool logResults, int threads);
+
+        /**
+         * @param seeds Draws the values of a random search
+         * @return each configuration of the sweep, in order
+         */
+        std::vector<PopulationParams> SweepConfigurations(
+                Util::UniformRandomGenerator<int, std::uniform_int_distribution<int>>& seeds) const;
+
+        /**
+         * @return the number of threads configured, or the number of hardware threads if not
+         */
+        int Threads() const;
+
+        /**
+         * Evolves a population that has just been reset for m_numGenerations, or until it meets the stopping criteria
+         * @param logger Logs the statistics of the initial population and of each generation, unless nullptr
+         * @return the fitness of the best S-expression
+         */
+        double Run(Population& population, GenerationLogger* logger) const;
+
+        /**
+         * Prints the best S-expression of an iteration, and how the population was evolved
+         * @param iteration The index of the iteration
+         * @param minimum The fitness of the best S-expression
+         */
+        void Report(const Population& population, int iteration, double minimum) const;
+
+        /**
+         * @return the population of the last iteration, or of the best configuration of a sweep
+         * @throws std::logic_error if neither Start nor Sweep has run
+         */
+        Population& Fitted();
+
         Config m_config{}; ///< parameters for the population
         std::unique_ptr<Population> m_population; ///< The chromosome population
+        std::unique_ptr<Population> m_lastReplica; ///< The population of the last iteration, if iterations ran side 
+                                                   ///< by side, or of the best configuration of a sweep
+        bool m_fitted = false; ///< Whether Start or Sweep has run, so there is a population to predict with
         int m_numGenerations = 20; ///< Number of generations to evolve through to find a solution
         int m_iterations = 1; ///< Number of times to run the experiment
-        Util::Logger<double, double, double, double, double, std::string> m_logger{""};
+        GenerationLogger m_logger{""}; ///< Logs each generation of each iteration
     };
 }
 
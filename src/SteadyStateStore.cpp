@@ -0,0 +1,43 @@
+#include "SteadyStateStore.h"
+
+namespace Model
+{
+    SteadyStateStore::SteadyStateStore(std::vector<ChromoPtr> chromosomes)
+        : m_slots(chromosomes.size())
+    {
+        for (auto i = 0u; i < chromosomes.size(); ++i)
+        {
+            m_slots[i].store(chromosomes[i].release(), std::memory_order_relaxed);
+        }
+    }
+
+    SteadyStateStore::~SteadyStateStore()
+    {
+        Release();
+    }
+
+    bool SteadyStateStore::Replace(int slot, const IChromosome* expected, ChromoPtr& chromosome)
+    {
+        auto current = const_cast<IChromosome*>(expected);
+        if (!m_slots[slot].compare_exchange_strong(current, chromosome.get(), std::memory_order_acq_rel))
+        {
+            return false;
+        }
+        chromosome.release();
+        m_replaced.Post(ChromoPtr(current));
+        return true;
+    }
+
+    std::vector<SteadyStateStore::ChromoPtr> SteadyStateStore::Release()
+    {
+        m_replaced.TakeAll();
+
+        std::vector<ChromoPtr> chromosomes;
+        chromosomes.reserve(m_slots.size());
+        for (auto& slot : m_slots)
+        {
+            chromosomes.emplace_back(slot.exchange(nullptr, std::memory_order_acquire));
+        }
+        return chromosomes;
+    }
+}
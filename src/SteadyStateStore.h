@@ -0,0 +1,72 @@
+#ifndef SteadyStateStore_H
+#define SteadyStateStore_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "model/IChromosome.h"
+#include "utils/Mailbox.h"
+
+namespace Model
+{
+    /**
+     * Stores the chromosomes of a steady-state population, which worker threads read and replace at the 
+     * same time.
+     *
+     * Each slot is an atomic pointer to its chromosome, and a chromosome is only replaced if its slot still
+     * holds the one the replacing worker compared against. Replaced chromosomes are kept until the store is
+     * released, since other workers may still be breeding from them, so a chromosome read from a slot stays
+     * valid (and unchanged) for the life of the store.
+     */
+    class SteadyStateStore
+    {
+    public:
+        using ChromoPtr = std::unique_ptr<IChromosome>;
+
+        /**
+         * Constructor
+         * @param chromosomes The chromosomes, one per slot
+         */
+        explicit SteadyStateStore(std::vector<ChromoPtr> chromosomes);
+
+        SteadyStateStore(const SteadyStateStore&) = delete;
+        SteadyStateStore& operator=(const SteadyStateStore&) = delete;
+
+        /**
+         * Destructor - Deletes the chromosomes, unless they have been released
+         */
+        ~SteadyStateStore();
+
+        /**
+         * @return the number of slots
+         */
+        int Size() const { return static_cast<int>(m_slots.size()); }
+
+        /**
+         * @return the chromosome in a slot
+         */
+        const IChromosome* Get(int slot) const { return m_slots[slot].load(std::memory_order_acquire); }
+
+        /**
+         * Replaces the chromosome in a slot, unless another worker has replaced it already
+         * @param slot The slot
+         * @param expected The chromosome that the slot is expected to hold
+         * @param chromosome The replacement, which is taken if (and only if) the slot is replaced
+         * @return true if the slot was replaced
+         */
+        bool Replace(int slot, const IChromosome* expected, ChromoPtr& chromosome);
+
+        /**
+         * Deletes the replaced chromosomes, and empties the slots. Must not be called while workers are 
+         * reading or replacing slots.
+         * @return the chromosome in each slot, by slot
+         */
+        std::vector<ChromoPtr> Release();
+
+    private:
+        std::vector<std::atomic<IChromosome*>> m_slots; ///< The chromosome in each slot, owned by the store
+        Util::Mailbox<ChromoPtr> m_replaced; ///< The chromosomes that have been replaced
+    };
+}
+
+#endif
@@ -4,6 +4,11 @@ int main()
 {
     const bool enableLogging = true;
     Model::Program p;
+    if (p.IsSweep())
+    {
+        p.Sweep(enableLogging);
+        return 0;
+    }
     p.Start(enableLogging);
     p.Predict();
     
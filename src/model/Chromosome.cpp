@@ -1,7 +1,13 @@
 #include "Chromosome.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include "Constant.h"
 #include "FunctionFactory.h"
 #include "ChromosomeUtil.h"
 
@@ -15,47 +21,89 @@ namespace Model
             const std::vector<double>& fitnessCases, 
             std::vector<double>& terminals, 
             double parsimonyCoefficient)
-        : m_tree(CreateRandomChromosome(targetSize, allowedFunctions, variables))
-        , m_size(m_tree->Size())
-        , m_fitness(CalculateFitness(fitnessCases, terminals))
-        , m_weightedFitness(CalculateWeightedFitness(parsimonyCoefficient))
+        : ChromosomeCore(CreateRandomChromosome(targetSize, allowedFunctions, variables))
     {
+        m_fitness = CalculateFitness(fitnessCases, terminals, std::numeric_limits<double>::max(), nullptr);
+        m_weightedFitness = CalculateWeightedFitness(parsimonyCoefficient);
     }
 
     Chromosome::Chromosome(IChromosome::INodePtr tree)
-        : m_tree(std::move(tree)) 
-        , m_size(m_tree->Size())
+        : ChromosomeCore(std::move(tree))
     {
     }
 
     Chromosome::Chromosome(IChromosome::INodePtr tree, const std::vector<double>& fitnessCases, 
-            std::vector<double>& terminals, double parsimonyCoefficient)
-        : m_tree(std::move(tree)) 
-        , m_size(m_tree->Size())
-        , m_fitness(CalculateFitness(fitnessCases, terminals))
-        , m_weightedFitness(CalculateWeightedFitness(parsimonyCoefficient))
+            std::vector<double>& terminals, double parsimonyCoefficient, double cutoff, bool linearScaling,
+            const RowPartition* rows)
+        : ChromosomeCore(std::move(tree))
+        , m_linearScaling(linearScaling)
     {
-    } 
+        m_fitness = CalculateFitness(fitnessCases, terminals, cutoff - parsimonyCoefficient * m_size, rows);
+        m_weightedFitness = CalculateWeightedFitness(parsimonyCoefficient);
+    }
 
     Chromosome::Chromosome(IChromosome::INodePtr& tree, double fitness, double parsimonyCoefficient)
-        : m_tree(std::move(tree)) 
-        , m_size(m_tree->Size())
-        , m_fitness(fitness)
-        , m_weightedFitness(CalculateWeightedFitness(parsimonyCoefficient))
+        : ChromosomeCore(std::move(tree))
     {
-    } 
+        m_fitness = fitness;
+        m_weightedFitness = CalculateWeightedFitness(parsimonyCoefficient);
+    }
 
-    bool Chromosome::operator<(const IChromosome& right) const
+    void Chromosome::Moments::Add(double f, double y)
     {
-        const auto rhs = dynamic_cast<const Chromosome*>(&right);
-        return m_weightedFitness < rhs->m_weightedFitness;
+        Count += 1.0;
+        double devF = f - MeanF;
+        double devY = y - MeanY;
+        MeanF += devF / Count;
+        MeanY += devY / Count;
+        SqDevF += devF * (f - MeanF);
+        SqDevY += devY * (y - MeanY);
+        CoDevFY += devF * (y - MeanY);
     }
 
-    double Chromosome::CalculateFitness(const std::vector<double>& fitnessCases, std::vector<double>& terminals)
+    void Chromosome::Moments::Merge(const Moments& other)
     {
+        if (other.Count == 0.0)
+        {
+            return;
+        }
+
+        double count = Count + other.Count;
+        double devF = other.MeanF - MeanF;
+        double devY = other.MeanY - MeanY;
+        double weight = Count * other.Count / count;
+        MeanF += devF * other.Count / count;
+        MeanY += devY * other.Count / count;
+        SqDevF += other.SqDevF + devF * devF * weight;
+        SqDevY += other.SqDevY + devY * devY * weight;
+        CoDevFY += other.CoDevFY + devF * devY * weight;
+        Count = count;
+    }
+
+    double Chromosome::Moments::SumOfSqErrors() const
+    {
+        return SqDevF > 0.0 ? SqDevY - CoDevFY*CoDevFY/SqDevF : SqDevY;
+    }
+
+    double Chromosome::CalculateFitness(const std::vector<double>& fitnessCases, std::vector<double>& terminals, double cutoff,
+            const RowPartition* rows)
+    {
+        bool rowParallel = rows && rows->Threads() > 1;
+        if (m_linearScaling)
+        {
+            return rowParallel ? CalculateRowParallelScaledFitness(fitnessCases, *rows, cutoff)
+                : CalculateScaledFitness(fitnessCases, terminals, cutoff);
+        }
+        if (rowParallel)
+        {
+            return CalculateRowParallelFitness(fitnessCases, *rows, cutoff);
+        }
+
         double sumOfErrors = 0.0;
         int columns = static_cast<int>(terminals.size()) + 1; // columns in csv file, incl dependent variable
         int totalCases = fitnessCases.size() / columns;       // rows in the csv file
+        double maxSumOfErrors = cutoff * totalCases;          // errors are never negative, so the partial MAE 
+                                                              // can only grow beyond this
 
         for (int i = 0; i < totalCases; ++i)
         {
@@ -69,249 +117,174 @@ namespace Model
 
             // add to the tally
             sumOfErrors += std::abs(returnVal - *end);
+            if (sumOfErrors > maxSumOfErrors)
+            {
+                break; // can't survive, so the lower bound will do
+            }
         }
         return sumOfErrors / totalCases; // mean absolute error
     }
 
-    double Chromosome::CalculateWeightedFitness(double parsimonyCoefficient) const
+    double Chromosome::CalculateScaledFitness(const std::vector<double>& fitnessCases, std::vector<double>& terminals, double cutoff)
     {
-        return m_fitness + parsimonyCoefficient * m_size;
-    }
+        int columns = static_cast<int>(terminals.size()) + 1; // columns in csv file, incl dependent variable
+        int totalCases = fitnessCases.size() / columns;       // rows in the csv file
+        double maxSumOfSqErrors = cutoff * std::abs(cutoff) * totalCases;
 
-    int Chromosome::Size() const
-    {
-        return m_size;
-    }
+        Moments moments;
+        for (int i = 0; i < totalCases; ++i)
+        {
+            // load up the terminals for this fitness case
+            auto begin = fitnessCases.begin() + i*columns;
+            auto end = begin + columns - 1;
+            std::copy(begin, end, terminals.begin());
+            moments.Add(m_tree->Evaluate(), *end);
 
-    double Chromosome::Fitness() const
-    {
-        return m_fitness;
+            // The best fit to the cases so far can only get worse as cases are added,
+            // so this is a lower bound on the final sum of squared errors.
+            if (moments.SumOfSqErrors() > maxSumOfSqErrors)
+            {
+                break; // can't survive, so the lower bound will do
+            }
+        }
+        return Scale(moments, totalCases);
     }
 
-    std::unique_ptr<IChromosome> Chromosome::Clone() const
+    double Chromosome::CalculateRowParallelFitness(const std::vector<double>& fitnessCases, const RowPartition& rows, double cutoff)
     {
-        return std::make_unique<Chromosome>(*this);
-    }
+        int columns = rows.Columns();                   // columns in csv file, incl dependent variable
+        int totalCases = fitnessCases.size() / columns; // rows in the csv file
+        double maxSumOfErrors = cutoff * totalCases;
+
+        // errors are never negative, so the chunks evaluated so far bound the total from below
+        std::atomic<double> evaluated{ 0.0 };
+        std::atomic<bool> cancel{ false };
+        auto sums = rows.Map<double>(*m_tree, totalCases, 
+            [&](const INode& tree, std::vector<double>& terminals, int first, int last)
+            {
+                double sumOfErrors = 0.0;
+                for (int i = first; i < last; ++i)
+                {
+                    auto begin = fitnessCases.begin() + i*columns;
+                    auto end = begin + columns - 1;
+                    std::copy(begin, end, terminals.begin());
+                    sumOfErrors += std::abs(tree.Evaluate() - *end);
+                }
 
-    Chromosome::Chromosome(const Chromosome& other)
-    {
-        m_tree = other.m_tree->Clone();
-        m_size = other.m_size;
-        m_fitness = other.m_fitness;
-        m_weightedFitness = other.m_weightedFitness;
+                auto total = evaluated.load();
+                while (!evaluated.compare_exchange_weak(total, total + sumOfErrors)) { }
+                if (total + sumOfErrors > maxSumOfErrors)
+                {
+                    cancel = true; // can't survive, so the lower bound will do
+                }
+                return sumOfErrors;
+            }, &cancel);
+        return std::accumulate(sums.begin(), sums.end(), 0.0) / totalCases; // mean absolute error
     }
 
-    void Chromosome::Mutate(const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables)
+    double Chromosome::CalculateRowParallelScaledFitness(const std::vector<double>& fitnessCases, const RowPartition& rows, double cutoff)
     {
-        auto randomTerminalMutation = [&](std::unique_ptr<INode>& gene) -> void
-        {
-            if (RandInt().GetInRange(0,1) && !allowedFunctions.empty()) // mutate to a function
-            {
-                int i = RandomIndex(allowedFunctions.size());
-                auto func = FunctionFactory::Create(allowedFunctions[i]);
-                FillFunction(func.get(), variables);
-                gene.swap(func);
-            }
-            else // mutate to a terminal
+        int columns = rows.Columns();                   // columns in csv file, incl dependent variable
+        int totalCases = fitnessCases.size() / columns; // rows in the csv file
+        double maxSumOfSqErrors = cutoff * std::abs(cutoff) * totalCases;
+
+        // the best fit to each chunk is no worse than the best fit to all of them, so the sum of the chunks'
+        // own sums of squared errors bounds the total from below
+        std::atomic<double> evaluated{ 0.0 };
+        std::atomic<bool> cancel{ false };
+        auto chunks = rows.Map<Moments>(*m_tree, totalCases, 
+            [&](const INode& tree, std::vector<double>& terminals, int first, int last)
             {
-                // Prevents mutation to the same terminal, if there are 2+ terminals available.
-                // TODO: this could likely be done in a more efficient manner.
-                std::vector<double*> tTypes(variables);
-                while (!tTypes.empty())
+                Moments moments;
+                for (int i = first; i < last; ++i)
                 {
-                    int i = RandomIndex(tTypes.size());
-                    auto newTerminal = FunctionFactory::Create(tTypes[i]);
-                    if (!gene->IsEquivalent(*newTerminal))
-                    {
-                        gene.swap(newTerminal);
-                        break;
-                    }
-                    auto itr = tTypes.begin() + i;
-                    tTypes.erase(itr);
+                    auto begin = fitnessCases.begin() + i*columns;
+                    auto end = begin + columns - 1;
+                    std::copy(begin, end, terminals.begin());
+                    moments.Add(tree.Evaluate(), *end);
                 }
-            }
-        };
-
-        auto randomFunctionMutation = [&](std::unique_ptr<INode>& gene) -> void
-        {
-            // copy function types, such that we can remove types and prevent an infinite loop 
-            // in the case where no function in the vector can handle the number of children.
-            // This does not (and cannot) guarantee that the function will change, since we 
-            // can't guarantee that a suitable replacement will be available to mutate to.
-            std::vector<FunctionType> fTypes(allowedFunctions);
-
-            while (!fTypes.empty())
-            {
-                int i = RandomIndex(fTypes.size());
-                auto newFunction = FunctionFactory::Create(fTypes[i]);
 
-                if (gene->NumberOfChildren() <= newFunction->MaxChildren()) // TODO: and children > MinChildren?
+                auto sumOfSqErrors = moments.SumOfSqErrors();
+                auto total = evaluated.load();
+                while (!evaluated.compare_exchange_weak(total, total + sumOfSqErrors)) { }
+                if (total + sumOfSqErrors > maxSumOfSqErrors)
                 {
-                    gene->MoveChildrenTo(newFunction); // transfer sub tree
-                    gene.swap(newFunction);
-                    break;
+                    cancel = true; // can't survive, so the lower bound will do
                 }
+                return moments;
+            }, &cancel);
 
-                auto itr = fTypes.begin() + i; 
-                fTypes.erase(itr);
-            }
-            // else the mutation fails
-        };
-        
-        // Randomly select a node in the chromosome tree 
-        int index = RandInt().GetInRange(0, m_size-1);
-        auto& gene = m_tree->Get(index, m_tree);
-
-        if (IsTerminal(gene))
-        {
-            randomTerminalMutation(gene);
-        }
-        else
+        Moments moments;
+        for (const auto& chunk : chunks)
         {
-            randomFunctionMutation(gene);
+            moments.Merge(chunk);
         }
-
-        // update the cached size of the chromosome
-        SetSize();
+        return Scale(moments, totalCases);
     }
 
-    void Chromosome::HoistMutate()
+    double Chromosome::Scale(const Moments& moments, int totalCases)
     {
-        // get the target gene from within chromosome
-        if (Size() == 1) 
-        {
-            return; // chromosome is a terminal; nothing to hoist
-        }
+        m_slope = moments.SqDevF > 0.0 ? moments.CoDevFY / moments.SqDevF : 0.0;
+        m_intercept = moments.MeanY - m_slope * moments.MeanF;
 
-        // get the target gene (that we'll hoist into)
-        auto index = RandInt().GetInRange(0, Size()-1);
-        auto& target = index == 0 ? m_tree : m_tree->Get(index, m_tree);
-
-        int targetSize = target->Size();
-        if (targetSize == 1)
-        {
-            return; // target is a terminal, so there is no subtree to hoist
-        }
-
-        // get the subtree to hoist, and swap them
-        index = RandInt().GetInRange(0, targetSize-1);
-        auto& toHoist = index == 0 ? target : target->Get(index, target);
-        target = std::move(toHoist);
-
-        // update the cached size of the chromosome
-        SetSize();
+        auto rootMeanSqError = std::sqrt(std::max(moments.SumOfSqErrors(), 0.0) / totalCases);
+        return std::isfinite(rootMeanSqError) ? rootMeanSqError : std::numeric_limits<double>::max();
     }
 
-    void Chromosome::Crossover(IChromosome& right)
+    std::unique_ptr<INode> Chromosome::CreateRoot(const std::vector<FunctionType>& allowedFunctions)
     {
-        auto rhs = dynamic_cast<Chromosome*>(&right);
-        if (Size() == 1 && rhs->Size() == 1)
-        {
-            // do nothing; swapping at the base yields two S-expressions the same
-            return;
-        }
-
-        // Pick a random node in left
-        if (Size() == 1)
-        {
-            m_tree.swap(rhs->GetTree()->Get(RandInt().GetInRange(1, rhs->Size()-1), rhs->GetTree()));
-        }
-        else if (rhs->Size() == 1)
-        {
-            rhs->GetTree().swap(m_tree->Get(RandInt().GetInRange(1, Size()-1), m_tree));
-        }
-        else
-        {
-            int leftIndex = RandInt().GetInRange(1, Size()-1);
-            int rhsIndex = RandInt().GetInRange(1, rhs->Size()-1);
-            auto& leftSubtree = m_tree->Get(leftIndex, m_tree);
-            leftSubtree.swap(rhs->GetTree()->Get(rhsIndex, rhs->GetTree()));
-        }
-
-        SetSize();
-        rhs->SetSize();
+        // start with a randomly selected function
+        int index = RandomIndex(allowedFunctions.size());
+        return FunctionFactory::Create(allowedFunctions[index]);
     }
 
-    void Chromosome::SetSize()
+    std::string Chromosome::ToString() const
     {
-        m_size = m_tree->Size();
-    }
+        if (!m_linearScaling)
+        {
+            return m_tree->ToString();
+        }
 
-    IChromosome::INodePtr& Chromosome::GetTree()
-    {
-        return m_tree;
+        std::stringstream output;
+        output << Constant::Format(m_intercept) << " + (" << Constant::Format(m_slope) << " * " << m_tree->ToString() << ")";
+        return output.str();
     }
 
-    const IChromosome::INodePtr& Chromosome::GetTree() const
+    void Chromosome::Forecast(const std::vector<double>& fitnessCases, std::vector<double>& terminals, double* predictions, int length) const
     {
-        return m_tree;
+        throw std::invalid_argument("Prediction is not yet implemented for ChromosomeType::Normal.");
     }
 
-    std::unique_ptr<INode> Chromosome::CreateRandomChromosome(int targetSize, const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables)
+    void Chromosome::Predict(std::vector<double>& predictionCases, std::vector<double>& terminals, int cutoff,
+            const RowPartition* rows) const
     {
-        // start with a randomly selected function
-        int index = RandomIndex(allowedFunctions.size());
-        auto root = FunctionFactory::Create(allowedFunctions[index]);
-
-        // keep a local list of function nodes, for easy reference
-        std::vector<INode*> functions;
-        functions.push_back(root.get());
+        int columns = static_cast<int>(terminals.size()) + 1; // incl dependent variable
+        int totalCases = predictionCases.size() / columns;
 
-        for (int count = 1; count < targetSize; ++count)
+        if (rows && rows->Threads() > 1)
         {
-            // Randomly choose a new function/variable
-            auto isFunction = RandInt().GetInRange(0, 1) == 0;
-            std::unique_ptr<INode> newNode;
-            if (isFunction)
-            {
-                // randomly select a function type
-                index = RandomIndex(allowedFunctions.size());
-                newNode = FunctionFactory::Create(allowedFunctions[index]); 
-                functions.push_back(newNode.get());
-            }
-            else 
-            {
-                // randomly select a variable
-                index = RandomIndex(variables.size());
-                newNode = FunctionFactory::Create(variables[index]);
-            }
-            
-            // get a random position to insert (must be a Function)
-            int insertIndex = -1;
-            do
-            {
-                insertIndex = RandInt().GetInRange(0, root->Size()-1);
-            } 
-            while (insertIndex != 0 && IsTerminal(root->Get(insertIndex, root)) );
-
-            // add the new node to the random position in the tree
-            if (!root->Get(insertIndex, root)->AddChild(std::move(newNode)) && isFunction)
-            {
-                functions.pop_back(); // remove from cache if failed
-            }
+            rows->Map<char>(*m_tree, totalCases, 
+                [&](const INode& tree, std::vector<double>& chunkTerminals, int first, int last)
+                {
+                    for (int i = first; i < last; ++i)
+                    {
+                        auto begin = predictionCases.begin() + i*columns;
+                        auto end = begin + columns - 1;
+                        std::copy(begin, end, chunkTerminals.begin());
+                        *end = m_intercept + m_slope * tree.Evaluate();
+                    }
+                    return char{};
+                });
+            return;
         }
-        
-        // Make sure none of the leaf nodes are functions, and that functions have
-        // their minimum number of children.
-        for (auto& func : functions)
+
+        for (int i = 0; i < totalCases; ++i)
         {
-            FillFunction(func, variables);
+            // load up the terminals for this case, and overwrite the dependent variable
+            auto begin = predictionCases.begin() + i*columns;
+            auto end = begin + columns - 1;
+            std::copy(begin, end, terminals.begin());
+            *end = m_intercept + m_slope * m_tree->Evaluate();
         }
-        return root;
-    }
-
-    std::string Chromosome::ToString() const
-    {
-        return m_tree->ToString();
-    }
-
-    void Chromosome::Forecast(const std::vector<double>& fitnessCases, std::vector<double>& terminals, double* predictions, int length) const
-    {
-        throw std::invalid_argument("Prediction is not yet implemented for ChromosomeType::Normal.");
-    }
-
-    void Chromosome::Predict(std::vector<double>& predictionCases, std::vector<double>& terminals, int cutoff) const
-    {
-        throw std::invalid_argument("Prediction is not yet implemented for ChromosomeType::Normal.");
     }
 }
@@ -3,7 +3,8 @@
 
 #include <memory>
 #include <vector>
-#include "IChromosome.h"
+#include "ChromosomeCore.h"
+#include "RowPartition.h"
 
 namespace Tests
 {
@@ -16,10 +17,11 @@ namespace Model
      * Represents an individual chromosome (S-expression) in the population,
      * together with it's fitness
      */
-    class Chromosome : public IChromosome
+    class Chromosome : public ChromosomeCore<Chromosome>
     {
     public:
         friend Tests::PopulationTest;
+        friend ChromosomeCore<Chromosome>;
 
         /**
          * Constructor - Creates a random Chromosome
@@ -40,13 +42,21 @@ namespace Model
         /**
          * Copy Constructor
          */
-        Chromosome(const Chromosome& other);
+        Chromosome(const Chromosome& other) = default;
 
         /**
          * Constructor - Calculates fitness and weighted fitness upon construction.
+         * @param cutoff If the weighted fitness is found to exceed the cutoff, evaluation stops early and
+         * the fitness is only a lower bound.
+         * @param linearScaling If true, the S-expression output is scaled by the least-squares slope and
+         * intercept against the expected values.
+         * @param rows If set, the fitness cases are split across its threads rather than evaluated by the
+         * calling thread alone
          */
         Chromosome(IChromosome::INodePtr tree, const std::vector<double>& fitnessCases, 
-                std::vector<double>& terminals, double parsimonyCoefficient);
+                std::vector<double>& terminals, double parsimonyCoefficient,
+                double cutoff = std::numeric_limits<double>::max(), bool linearScaling = false,
+                const RowPartition* rows = nullptr);
 
         /**
          * Constructor - Calculates only the weighted fitness upon construction.
@@ -54,91 +64,94 @@ namespace Model
         Chromosome(IChromosome::INodePtr& tree, double fitness, double parsimonyCoefficient);
 
         /**
-         * Less-than operator. Used for sorting collections of Chromosomes.
+         * @see IChromosome::ToString
          */
-        bool operator<(const IChromosome& right) const override;
+        std::string ToString() const override;
 
         /**
-         * @see IChromosome::Size
+         * @see IChromosome::Forecast
          */
-        int Size() const override;
+        void Forecast(const std::vector<double>& fitnessCases, std::vector<double>& terminals, double* predictions, int length) const override;
 
         /**
-         * @see IChromosome::Fitness
+         * @see IChromosome::Predict
          */
-        double Fitness() const override;
+        void Predict(std::vector<double>& predictionCases, std::vector<double>& terminals, int cutoff = 0,
+                const RowPartition* rows = nullptr) const override;
 
+    private:
         /**
-         * @see IChromosome::Clone
+         * Running means and (co)moments of the output f and expected value y over some fitness cases
          */
-        std::unique_ptr<IChromosome> Clone() const override;
+        struct Moments
+        {
+            double Count = 0.0;
+            double MeanF = 0.0, MeanY = 0.0;
+            double SqDevF = 0.0, SqDevY = 0.0, CoDevFY = 0.0;
 
-        /**
-         * @see IChromosome::Mutate
-         */
-        void Mutate(const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables) override;
+            /**
+             * Adds a fitness case, as per Welford's method
+             */
+            void Add(double f, double y);
 
-        /**
-         * @see IChromosome::HoistMutate
-         */
-        void HoistMutate() override;
+            /**
+             * Adds the fitness cases of other, as per Chan et al.'s pairwise method
+             */
+            void Merge(const Moments& other);
 
-        /**
-         * @see IChromosome::Crossover
-         */
-        void Crossover(IChromosome& right) override;
+            /**
+             * @return the sum of squared errors of the least-squares fit to these fitness cases, which can only get 
+             * worse as cases are added
+             */
+            double SumOfSqErrors() const;
+        };
 
         /**
-         * @see IChromosome::GetTree
-         */
-        IChromosome::INodePtr& GetTree() override;
-        const IChromosome::INodePtr& GetTree() const override;
-
-        /**
-         * Creates a new, random chromosome
-         * @param targetSize The number of nodes in the chromosome tree we'd like. The
-         * number created is not deterministic, so targetSize acts as a minimum.
-         * @param allowedFunctions The set of functions allowed in the chromosome tree.
-         * @param variables The allowed set of terminals that may be selected from
-         * @return the root of the new chromosome
+         * Calculate the fitness for one chromosome. Currently uses MAE (mean absolute error), or the RMSE
+         * (root mean squared error) after scaling if linear scaling is enabled.
+         * @param chromosome The chromosome to evaluate
+         * @return the chromosome fitness as a positive, real number
          */
-        static std::unique_ptr<INode> CreateRandomChromosome(int targetSize, const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables);
+        double CalculateFitness(const std::vector<double>& fitnessCases, std::vector<double>& terminals, double cutoff,
+                const RowPartition* rows);
 
         /**
-         * @see IChromosome::ToString
+         * Calculates the MAE with the fitness cases split into chunks across threads. The sums of the absolute
+         * errors of each chunk are added in order of rows, so the result doesn't depend on the number of threads.
+         * @see CalculateFitness
          */
-        std::string ToString() const override;
+        double CalculateRowParallelFitness(const std::vector<double>& fitnessCases, const RowPartition& rows, double cutoff);
 
         /**
-         * @see IChromosome::Forecast
+         * Calculates the RMSE of a + b*f, where f is the S-expression output and a and b are the least-squares 
+         * intercept and slope. These are accumulated from running sums in a single pass over the fitness cases.
+         * @see CalculateFitness
          */
-        void Forecast(const std::vector<double>& fitnessCases, std::vector<double>& terminals, double* predictions, int length) const override;
+        double CalculateScaledFitness(const std::vector<double>& fitnessCases, std::vector<double>& terminals, double cutoff);
 
         /**
-         * @see IChromosome::Predict
+         * Calculates the scaled RMSE with the fitness cases split into chunks across threads. The running sums 
+         * of each chunk are merged in order of rows, so the result doesn't depend on the number of threads.
+         * @see CalculateScaledFitness
          */
-        void Predict(std::vector<double>& predictionCases, std::vector<double>& terminals, int cutoff = 0) const override;
-
-    private:
+        double CalculateRowParallelScaledFitness(const std::vector<double>& fitnessCases, const RowPartition& rows, double cutoff);
 
         /**
-         * Calculate the fitness for one chromosome. Currently uses MAE (mean absolute error)
-         * @param chromosome The chromosome to evaluate
-         * @return the chromosome fitness as a positive, real number
+         * Sets the slope and intercept of the least-squares fit to the fitness cases
+         * @param moments The running sums over the fitness cases
+         * @param totalCases The number of fitness cases
+         * @return the RMSE of the scaled output
          */
-        double CalculateFitness(const std::vector<double>& fitnessCases, std::vector<double>& terminals) override;
-
-        double CalculateWeightedFitness(double parsimonyCoefficient) const override;
+        double Scale(const Moments& moments, int totalCases);
 
         /**
-         * @see IChromosome::SetSize
+         * @return the root of a new, random S-expression, which may be any of the allowed functions
          */
-        void SetSize() override;
+        static std::unique_ptr<INode> CreateRoot(const std::vector<FunctionType>& allowedFunctions);
 
-        IChromosome::INodePtr m_tree; ///< the S-expression
-        int m_size; ///< the length (nodes in the tree)
-        double m_fitness = std::numeric_limits<double>::max(); ///< raw fitness of the chromosome
-        double m_weightedFitness = std::numeric_limits<double>::max(); ///< weighted fitness, with penalty for length/size
+        bool m_linearScaling = false; ///< whether the output of the S-expression is scaled by m_slope and m_intercept
+        double m_intercept = 0.0; ///< least-squares intercept of the scaled output
+        double m_slope = 1.0; ///< least-squares slope of the scaled output
     };
 }
 
@@ -0,0 +1,161 @@
+#include "ChromosomeCore.h"
+
+#include "Chromosome.h"
+#include "ChromosomeUtil.h"
+#include "MutationTable.h"
+#include "TimeSeriesChromosome.h"
+
+namespace Model
+{
+    using namespace ChromosomeUtil;
+
+    template <typename FitnessModel>
+    ChromosomeCore<FitnessModel>::ChromosomeCore(IChromosome::INodePtr tree)
+        : m_tree(std::move(tree))
+    {
+        m_size = m_tree->Size();
+        m_cost = m_size;
+    }
+
+    template <typename FitnessModel>
+    ChromosomeCore<FitnessModel>::ChromosomeCore(const ChromosomeCore& other)
+        : IChromosome(other)
+        , m_tree(other.m_tree->Clone())
+    {
+    }
+
+    template <typename FitnessModel>
+    std::unique_ptr<IChromosome> ChromosomeCore<FitnessModel>::Clone() const
+    {
+        return std::make_unique<FitnessModel>(static_cast<const FitnessModel&>(*this));
+    }
+
+    template <typename FitnessModel>
+    void ChromosomeCore<FitnessModel>::Mutate(const MutationTable& mutations)
+    {
+        // Randomly select a node in the chromosome tree
+        auto& nodes = Index().Slots;
+        int index = RandInt().GetInRange(0, static_cast<int>(nodes.size())-1);
+        mutations.Mutate(*nodes[index]);
+
+        // update the cached size of the chromosome
+        SetSize();
+        SetModifiedBy(GeneticOperator::Mutation);
+    }
+
+    template <typename FitnessModel>
+    void ChromosomeCore<FitnessModel>::HoistMutate()
+    {
+        // get the target gene from within chromosome
+        if (Size() == 1)
+        {
+            return; // chromosome is a terminal; nothing to hoist
+        }
+
+        // get the target gene (that we'll hoist into)
+        const auto& index = Index();
+        auto target = RandInt().GetInRange(0, static_cast<int>(index.Slots.size())-1);
+
+        int targetSize = index.Sizes[target];
+        if (targetSize == 1)
+        {
+            return; // target is a terminal, so there is no subtree to hoist
+        }
+
+        // get the subtree to hoist (the target's subtree follows it in prefix order), and swap them
+        auto toHoist = target + RandInt().GetInRange(0, targetSize-1);
+        *index.Slots[target] = std::move(*index.Slots[toHoist]);
+
+        // update the cached size of the chromosome
+        SetSize();
+        SetModifiedBy(GeneticOperator::HoistMutation);
+    }
+
+    template <typename FitnessModel>
+    void ChromosomeCore<FitnessModel>::Crossover(IChromosome& right, const TreeLimits& limits)
+    {
+        // a population only ever holds one type of Chromosome
+        auto& rhs = static_cast<FitnessModel&>(right);
+        if (Size() == 1 && rhs.Size() == 1)
+        {
+            // do nothing; swapping at the base yields two S-expressions the same
+            return;
+        }
+
+        const auto& leftNodes = Index();
+        const auto& rightNodes = rhs.Index();
+        for (int attempt = 0; attempt <= limits.Retries; ++attempt)
+        {
+            // Pick a random node in each (other than the root, unless it's the only node)
+            int leftIndex = leftNodes.Slots.size() == 1 ? 0 : RandInt().GetInRange(1, static_cast<int>(leftNodes.Slots.size())-1);
+            int rightIndex = rightNodes.Slots.size() == 1 ? 0 : RandInt().GetInRange(1, static_cast<int>(rightNodes.Slots.size())-1);
+
+            // the rest of each tree is unchanged, so only the depth of the incoming subtree need be checked
+            int leftSize = Size() - leftNodes.Sizes[leftIndex] + rightNodes.Sizes[rightIndex];
+            int rightSize = rhs.Size() - rightNodes.Sizes[rightIndex] + leftNodes.Sizes[leftIndex];
+            if (limits.Allow(leftNodes.Depths[leftIndex] + rightNodes.Heights[rightIndex], leftSize)
+                    && limits.Allow(rightNodes.Depths[rightIndex] + leftNodes.Heights[leftIndex], rightSize))
+            {
+                leftNodes.Slots[leftIndex]->swap(*rightNodes.Slots[rightIndex]);
+
+                SetSize();
+                rhs.SetSize();
+                SetModifiedBy(GeneticOperator::Crossover);
+                rhs.SetModifiedBy(GeneticOperator::Crossover);
+                return;
+            }
+        }
+        // rejected; the chromosomes are left as they were
+    }
+
+    template <typename FitnessModel>
+    void ChromosomeCore<FitnessModel>::SetSize()
+    {
+        m_size = m_tree->Size();
+        m_cost = m_size;
+        m_index.Clear(); // the tree has changed
+        static_cast<FitnessModel*>(this)->OnTreeChanged();
+    }
+
+    template <typename FitnessModel>
+    const NodeIndex& ChromosomeCore<FitnessModel>::Index()
+    {
+        if (m_index.Slots.empty())
+        {
+            m_tree->IndexNodes(m_tree, m_index, 0);
+        }
+        return m_index;
+    }
+
+    template <typename FitnessModel>
+    IChromosome::INodePtr& ChromosomeCore<FitnessModel>::GetTree()
+    {
+        m_index.Clear(); // the caller may change the tree
+        return m_tree;
+    }
+
+    template <typename FitnessModel>
+    const IChromosome::INodePtr& ChromosomeCore<FitnessModel>::GetTree() const
+    {
+        return m_tree;
+    }
+
+    template <typename FitnessModel>
+    std::unique_ptr<INode> ChromosomeCore<FitnessModel>::CreateRandomChromosome(int targetSize, const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables, bool full)
+    {
+        auto root = FitnessModel::CreateRoot(allowedFunctions);
+        GrowTree(root.get(), targetSize, full, allowedFunctions, variables);
+        return root;
+    }
+
+    template <typename FitnessModel>
+    std::unique_ptr<INode> ChromosomeCore<FitnessModel>::CreateRandomChromosomeToDepth(int depth, const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables, bool full)
+    {
+        auto root = FitnessModel::CreateRoot(allowedFunctions);
+        GrowTreeToDepth(root.get(), depth, full, allowedFunctions, variables);
+        return root;
+    }
+
+    template class ChromosomeCore<Chromosome>;
+    template class ChromosomeCore<TimeSeriesChromosome>;
+}
@@ -0,0 +1,106 @@
+#ifndef ChromosomeCore_H
+#define ChromosomeCore_H
+
+#include <memory>
+#include <vector>
+#include "IChromosome.h"
+
+namespace Model
+{
+    /**
+     * The parts of a Chromosome that don't depend on how its fitness is measured: the S-expression,
+     * its node index, and the genetic operators that act upon it.
+     *
+     * The template parameter is the derived Chromosome type (CRTP), which provides the fitness model:
+     * - static std::unique_ptr<INode> CreateRoot(const std::vector<FunctionType>& allowedFunctions),
+     *   the root of a new, random S-expression
+     * - void OnTreeChanged(), called whenever the S-expression has changed (optional)
+     *
+     * Calls to the fitness model are resolved at compile time, and since a population only ever holds one
+     * type of Chromosome, crossover casts its partner statically rather than checking its type at run time.
+     */
+    template <typename FitnessModel>
+    class ChromosomeCore : public IChromosome
+    {
+    public:
+        /**
+         * @see IChromosome::Clone
+         */
+        std::unique_ptr<IChromosome> Clone() const override;
+
+        /**
+         * @see IChromosome::Mutate
+         */
+        void Mutate(const MutationTable& mutations) override;
+
+        /**
+         * @see IChromosome::HoistMutate
+         */
+        void HoistMutate() override;
+
+        /**
+         * @see IChromosome::Crossover
+         * @pre right is of the same type as this Chromosome
+         */
+        void Crossover(IChromosome& right, const TreeLimits& limits) override;
+
+        /**
+         * @see IChromosome::GetTree
+         */
+        IChromosome::INodePtr& GetTree() override;
+        const IChromosome::INodePtr& GetTree() const override;
+
+        /**
+         * Creates a new, random chromosome
+         * @param targetSize The number of nodes in the chromosome tree we'd like. The
+         * number created is not deterministic, so targetSize acts as a minimum.
+         * @param allowedFunctions The set of functions allowed in the chromosome tree.
+         * @param variables The allowed set of terminals that may be selected from
+         * @param full If true, the tree is built from functions only (other than its leaves)
+         * @return the root of the new chromosome
+         */
+        static std::unique_ptr<INode> CreateRandomChromosome(int targetSize, const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables, bool full = false);
+
+        /**
+         * Creates a new, random chromosome no deeper than the given depth
+         * @param depth The depth of the deepest nodes, where the root is at depth 0
+         * @param allowedFunctions The set of functions allowed in the chromosome tree.
+         * @param variables The allowed set of terminals that may be selected from
+         * @param full If true, every branch is built from functions down to the depth
+         * @return the root of the new chromosome
+         */
+        static std::unique_ptr<INode> CreateRandomChromosomeToDepth(int depth, const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables, bool full);
+
+    protected:
+        /**
+         * Constructor - Does no fitness calculations upon construction
+         * @param tree The underlying S-expression
+         */
+        explicit ChromosomeCore(IChromosome::INodePtr tree);
+
+        /**
+         * Copy Constructor. The node index is rebuilt for the copied tree when it's next needed.
+         */
+        ChromosomeCore(const ChromosomeCore& other);
+
+        /**
+         * Set the cached size (and cost) of the Chromosome, after its S-expression has changed
+         */
+        void SetSize();
+
+        /**
+         * @return the index of the nodes in the S-expression, which is rebuilt if out of date
+         */
+        const NodeIndex& Index();
+
+        /**
+         * Default fitness model hook, for models that cache nothing about the S-expression
+         */
+        void OnTreeChanged() {}
+
+        IChromosome::INodePtr m_tree; ///< the S-expression
+        NodeIndex m_index; ///< the nodes of m_tree in prefix order, built upon demand. Empty if out of date.
+    };
+}
+
+#endif
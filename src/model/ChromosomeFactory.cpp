@@ -1,77 +1,582 @@
 #include "ChromosomeFactory.h"
 
-#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_set>
+#include <Eigen/Dense>
 
 #include "Chromosome.h"
+#include "ChromosomeUtil.h"
+#include "Constant.h"
+#include "SemanticChromosome.h"
 #include "TimeSeriesChromosome.h"
 
-namespace Model
+namespace
 {
-    std::unique_ptr<ChromosomeFactory> ChromosomeFactory::s_instance = nullptr;
+    // The fitness assigned to Chromosomes that are rejected without evaluation
+    const double WorstFitness = std::numeric_limits<double>::max();
 
-    void ChromosomeFactory::Initialise(ChromosomeType type, int targetSize, 
-            const std::vector<FunctionType>& allowedFunctions, 
-            const std::vector<double*>& variables, 
-            const std::vector<double>& fitnessCases, 
-            std::vector<double>& terminals)
+    // Levenberg-Marquardt settings for tuning constants
+    const int TuningIterations = 10;     // the maximum number of accepted steps
+    const double InitialDamping = 1e-3;  // the initial weight of the gradient descent term
+    const double MaxDamping = 1e10;      // stop once steps are so heavily damped that they're negligible
+    const double MinCurvature = 1e-12;   // prevents a singular system for constants with no effect
+
+    // Initialisation settings
+    const int MinRampedDepth = 2;    // the shallowest depth that ramped initialisation builds S-expressions to
+    const int DuplicateRetries = 10; // the number of times a duplicate S-expression is re-created before it's accepted
+
+    /**
+     * Appends pointers to all Constants in the tree to constants, in pre-order
+     */
+    void FindConstants(Model::INode* node, std::vector<Model::Constant*>& constants)
+    {
+        if (auto constant = dynamic_cast<Model::Constant*>(node))
+        {
+            constants.push_back(constant);
+        }
+        else if (node->MaxChildren() != 0)
+        {
+            for (auto& child : node->GetChildren())
+            {
+                FindConstants(child.get(), constants);
+            }
+        }
+    }
+
+    /**
+     * Appends pointers to all Constants in the tree to seeds, in pre-order, to differentiate with respect to
+     */
+    void FindSeeds(const Model::INode* node, std::vector<const Model::INode*>& seeds)
+    {
+        if (dynamic_cast<const Model::Constant*>(node))
+        {
+            seeds.push_back(node);
+        }
+        else if (node->MaxChildren() != 0)
+        {
+            for (const auto& child : node->GetChildren())
+            {
+                FindSeeds(child.get(), seeds);
+            }
+        }
+    }
+
+    /**
+     * Finds the range of values each variable takes over the fitness cases
+     * @param type The type of Chromosome, which determines the layout of the fitness cases
+     * @param variables Pointers to the variables
+     * @param fitnessCases The training data
+     */
+    Model::VariableRanges GetVariableRanges(Model::ChromosomeType type, const std::vector<double*>& variables,
+            const std::vector<double>& fitnessCases)
     {
-        if (s_instance == nullptr)
+        Model::VariableRanges ranges;
+        if (fitnessCases.empty())
         {
-            auto temp = std::unique_ptr<ChromosomeFactory>(new ChromosomeFactory(type, targetSize, 
-                        allowedFunctions, variables, fitnessCases, terminals));
-            s_instance = std::move(temp);
+            return ranges;
         }
-        else 
+
+        if (type == Model::ChromosomeType::TimeSeries)
         {
-            std::cout << "ChromosomeFactory should only be initialized once!" << std::endl;
+            // every variable is a lagged value of the same series
+            auto [min, max] = std::minmax_element(fitnessCases.begin(), fitnessCases.end());
+            for (auto variable : variables)
+            {
+                ranges[variable] = { *min, *max };
+            }
+            return ranges;
         }
+
+        auto columns = variables.size() + 1; // incl. dependent variable
+        for (auto j = 0u; j < variables.size(); ++j)
+        {
+            Util::Interval range = Util::Interval::Empty();
+            for (auto i = j; i < fitnessCases.size(); i += columns)
+            {
+                range = Util::Hull(range, Util::Interval::Point(fitnessCases[i]));
+            }
+            ranges[variables[j]] = range;
+        }
+        return ranges;
     }
+}
 
-    ChromosomeFactory::ChromosomeFactory(ChromosomeType type, int targetSize, 
-            const std::vector<FunctionType>& allowedFunctions, 
+namespace Model
+{
+    ChromosomeFactory::ChromosomeFactory(const PopulationParams& params, 
             const std::vector<double*>& variables, 
+            const std::vector<double*>& terminalSet,
             const std::vector<double>& fitnessCases, 
-            std::vector<double>& terminals)
-        : m_type(type)
-        , m_targetSize(targetSize)
-        , m_allowedFunctions(allowedFunctions)
+            std::vector<double>& terminals,
+            const CostTable* costs)
+        : m_type(params.Type)
+        , m_targetSize(params.MinInitialTreeSize)
+        , m_initialisation(params.Initialisation)
+        , m_allowedFunctions(params.AllowedFunctions)
         , m_variables(variables)
+        , m_terminalSet(terminalSet)
         , m_fitnessCases(fitnessCases)
         , m_terminals(terminals)
+        , m_intervalAnalysis(params.IntervalAnalysis)
+        , m_ranges(GetVariableRanges(params.Type, variables, fitnessCases))
+        , m_linearScaling(params.LinearScaling)
+        , m_costs(costs)
     {
+        if (m_type == ChromosomeType::GeometricSemantic)
+        {
+            m_genealogy = std::make_shared<Genealogy>(params.AllowedFunctions, terminalSet, fitnessCases, terminals,
+                    params.GeometricMutationStep);
+        }
     }
 
-    const ChromosomeFactory& ChromosomeFactory::Inst()
+
+    std::unique_ptr<IChromosome> ChromosomeFactory::CreateRandom(double parsimonyCoefficient) const
     {
-        return *s_instance;
+        if (m_initialisation == InitialisationMethod::Ramped)
+        {
+            bool full = ChromosomeUtil::RandInt().GetInRange(0, 1) == 0;
+            int depth = ChromosomeUtil::RandInt().GetInRange(MinRampedDepth, MaxRampedDepth());
+            return CopyAndEvaluate(CreateRandomTreeToDepth(depth, full), parsimonyCoefficient);
+        }
+
+        bool full = m_initialisation == InitialisationMethod::Full;
+        return CopyAndEvaluate(CreateRandomTree(m_targetSize, full), parsimonyCoefficient);
     }
 
+    std::vector<std::unique_ptr<INode>> ChromosomeFactory::CreateUniqueRandomTrees(int count, Util::ThreadPool& pool) const
+    {
+        // the shape of the i'th S-expression
+        int depths = MaxRampedDepth() - MinRampedDepth + 1;
+        auto createTree = [this, depths](int i)
+        {
+            switch (m_initialisation)
+            {
+            case InitialisationMethod::Ramped:
+                return CreateRandomTreeToDepth(MinRampedDepth + (i / 2) % depths, i % 2 == 1);
 
-    std::unique_ptr<IChromosome> ChromosomeFactory::CreateRandom(double parsimonyCoefficient) const
+            case InitialisationMethod::Full:
+                return CreateRandomTree(m_targetSize, true);
+
+            case InitialisationMethod::Grow:
+            default:
+                return CreateRandomTree(m_targetSize, false);
+            }
+        };
+
+        // create a tree that isn't already in the set of hashes, if possible
+        auto createUniqueTree = [&createTree](int i, std::unordered_set<std::size_t>& hashes)
+        {
+            auto tree = createTree(i);
+            for (int attempt = 0; attempt < DuplicateRetries && hashes.count(tree->Hash()) != 0; ++attempt)
+            {
+                tree = createTree(i);
+            }
+            hashes.insert(tree->Hash());
+            return tree;
+        };
+
+        std::vector<std::unique_ptr<INode>> trees(count);
+        int threads = pool.Size();
+        std::vector<int> seeds(threads);
+        for (auto& seed : seeds)
+        {
+            seed = ChromosomeUtil::RandInt().GetInRange(0, std::numeric_limits<int>::max());
+        }
+
+        // each worker creates every threads'th tree, unique amongst its own trees
+        pool.Run([&](int w)
+        {
+            ChromosomeUtil::SetSeed(seeds[w]);
+            std::unordered_set<std::size_t> hashes;
+            for (int i = w; i < count; i += threads)
+            {
+                trees[i] = createUniqueTree(i, hashes);
+            }
+        });
+
+        // then replace duplicates between workers in order, so the result doesn't depend on timing
+        std::unordered_set<std::size_t> hashes;
+        for (int i = 0; i < count; ++i)
+        {
+            if (!hashes.insert(trees[i]->Hash()).second)
+            {
+                trees[i] = createUniqueTree(i, hashes);
+            }
+        }
+        return trees;
+    }
+
+    std::unique_ptr<INode> ChromosomeFactory::CreateRandomTreeToDepth(int depth, bool full) const
     {
         switch (m_type)
         {
         case ChromosomeType::TimeSeries:
-            return std::make_unique<TimeSeriesChromosome>(m_targetSize, m_allowedFunctions, m_variables, 
-                    m_fitnessCases, m_terminals, parsimonyCoefficient);
+            return TimeSeriesChromosome::CreateRandomChromosomeToDepth(depth, m_allowedFunctions, m_terminalSet, full);
 
         case ChromosomeType::Normal:
         default:
-            return std::make_unique<Chromosome>(m_targetSize, m_allowedFunctions, m_variables, 
-                    m_fitnessCases, m_terminals, parsimonyCoefficient);
+            return Chromosome::CreateRandomChromosomeToDepth(depth, m_allowedFunctions, m_terminalSet, full);
         }
     }
 
-    std::unique_ptr<IChromosome> ChromosomeFactory::CopyAndEvaluate(std::unique_ptr<INode> tree, double parsimonyCoefficient) const
+    int ChromosomeFactory::MaxRampedDepth() const
+    {
+        // the depth of the smallest full binary tree of at least twice the minimum size
+        int depth = 0;
+        for (int nodes = 1; nodes < 2*m_targetSize; nodes = 2*nodes + 1)
+        {
+            ++depth;
+        }
+        return std::max(MinRampedDepth, depth);
+    }
+
+    std::unique_ptr<INode> ChromosomeFactory::CreateRandomTree(int targetSize, bool full) const
     {
         switch (m_type)
         {
         case ChromosomeType::TimeSeries:
-            return std::make_unique<TimeSeriesChromosome>(std::move(tree), m_fitnessCases, m_terminals, parsimonyCoefficient);
+            return TimeSeriesChromosome::CreateRandomChromosome(targetSize, m_allowedFunctions, m_terminalSet, full);
 
         case ChromosomeType::Normal:
         default:
-            return std::make_unique<Chromosome>(std::move(tree), m_fitnessCases, m_terminals, parsimonyCoefficient);
+            return Chromosome::CreateRandomChromosome(targetSize, m_allowedFunctions, m_terminalSet, full);
+        }
+    }
+
+    std::unique_ptr<IChromosome> ChromosomeFactory::CopyAndEvaluate(std::unique_ptr<INode> tree, double parsimonyCoefficient,
+            double cutoff) const
+    {
+        return CopyAndEvaluate(std::move(tree), parsimonyCoefficient, cutoff, m_terminals);
+    }
+
+    std::unique_ptr<IChromosome> ChromosomeFactory::CopyAndEvaluate(std::unique_ptr<INode> tree, double parsimonyCoefficient,
+            double cutoff, std::vector<double>& terminals, const RowPartition* rows) const
+    {
+        if (m_intervalAnalysis && !Simplify(tree))
+        {
+            return CreateUnevaluated(std::move(tree), parsimonyCoefficient);
         }
+
+        double cost = m_costs ? tree->Cost(*m_costs) : tree->Size();
+        if (m_costs)
+        {
+            // Chromosomes bound their fitness by the cutoff less the penalty for their size, which 
+            // must be shifted to the penalty for their cost
+            cutoff -= parsimonyCoefficient * (cost - tree->Size());
+        }
+
+        // S-expressions are evaluated with the given terminals, then pointed back to the factory's. The
+        // genealogy of GeometricSemantic Chromosomes does so itself, and a row partition points copies of
+        // the S-expression to the terminals of each of its threads.
+        bool rebind = &terminals != &m_terminals && m_type != ChromosomeType::GeometricSemantic && !rows;
+        if (rebind)
+        {
+            tree->Rebind(m_terminals.data(), terminals.data(), m_terminals.size());
+        }
+
+        std::unique_ptr<IChromosome> chromosome;
+        switch (m_type)
+        {
+        case ChromosomeType::TimeSeries:
+            chromosome = std::make_unique<TimeSeriesChromosome>(std::move(tree), m_fitnessCases, terminals, 
+                    parsimonyCoefficient, rows); // time series are never cut off
+            break;
+
+        case ChromosomeType::GeometricSemantic:
+        {
+            auto semantic = std::make_unique<SemanticChromosome>(m_genealogy, std::move(tree), terminals);
+            semantic->Evaluate(m_fitnessCases, parsimonyCoefficient);
+            chromosome = std::move(semantic);
+            break;
+        }
+
+        case ChromosomeType::Normal:
+        default:
+            chromosome = std::make_unique<Chromosome>(std::move(tree), m_fitnessCases, terminals, 
+                    parsimonyCoefficient, cutoff, m_linearScaling, rows);
+            break;
+        }
+        if (rebind)
+        {
+            chromosome->GetTree()->Rebind(terminals.data(), m_terminals.data(), m_terminals.size());
+        }
+        if (m_costs)
+        {
+            chromosome->SetCost(cost, parsimonyCoefficient);
+        }
+        return chromosome;
+    }
+
+    std::unique_ptr<IChromosome> ChromosomeFactory::Evaluate(std::unique_ptr<IChromosome> chromosome, 
+            double parsimonyCoefficient, std::vector<double>& terminals, double cutoff, const RowPartition* rows) const
+    {
+        if (m_type == ChromosomeType::GeometricSemantic)
+        {
+            // the operators have already calculated the semantics, so the fitness follows without any S-expression
+            static_cast<SemanticChromosome&>(*chromosome).Evaluate(m_fitnessCases, parsimonyCoefficient);
+            return chromosome;
+        }
+        return CopyAndEvaluate(std::move(chromosome->GetTree()), parsimonyCoefficient, cutoff, terminals, rows);
+    }
+
+    std::unique_ptr<IChromosome> ChromosomeFactory::CreateUnevaluated(std::unique_ptr<INode> tree, double parsimonyCoefficient) const
+    {
+        std::unique_ptr<IChromosome> chromosome;
+        switch (m_type)
+        {
+        case ChromosomeType::TimeSeries:
+            chromosome = std::make_unique<TimeSeriesChromosome>(std::move(tree), WorstFitness, parsimonyCoefficient);
+            break;
+
+        case ChromosomeType::GeometricSemantic:
+        {
+            std::vector<double> terminals(m_terminals.size()); // of its own, since several threads may cull at once
+            chromosome = std::make_unique<SemanticChromosome>(m_genealogy, std::move(tree), terminals);
+            chromosome->Reweigh(parsimonyCoefficient); // of the worst fitness
+            break;
+        }
+
+        case ChromosomeType::Normal:
+        default:
+            chromosome = std::make_unique<Chromosome>(tree, WorstFitness, parsimonyCoefficient);
+            break;
+        }
+        if (m_costs)
+        {
+            chromosome->SetCost(chromosome->GetTree()->Cost(*m_costs), parsimonyCoefficient);
+        }
+        return chromosome;
+    }
+
+    bool ChromosomeFactory::Simplify(std::unique_ptr<INode>& tree) const
+    {
+        auto bounds = tree->FoldConstants(m_ranges);
+
+        if (m_type == ChromosomeType::TimeSeries)
+        {
+            if (tree->NumberOfChildren() == 0)
+            {
+                return !bounds.IsNonFinite();
+            }
+
+            // the root is kept, since each of its children is a term in the autoregressive model,
+            // and a single non-finite term spoils the least-squares fit of all of them
+            const auto& terms = tree->GetChildren();
+            return std::none_of(terms.begin(), terms.end(), 
+                    [this](const auto& term) { return term->EvaluateInterval(m_ranges).IsNonFinite(); });
+        }
+
+        if (bounds.IsPoint() && tree->MaxChildren() != 0)
+        {
+            tree = std::make_unique<Constant>(bounds.Lower);
+        }
+        return !bounds.IsNonFinite();
+    }
+
+    std::unique_ptr<IChromosome> ChromosomeFactory::TuneConstants(const IChromosome& chromosome, 
+            double parsimonyCoefficient, std::vector<double>& terminals, const RowPartition* rows) const
+    {
+        if (m_type != ChromosomeType::Normal)
+        {
+            return nullptr;
+        }
+
+        auto tree = chromosome.GetTree()->Clone();
+        std::vector<Constant*> constants;
+        FindConstants(tree.get(), constants);
+        if (constants.empty())
+        {
+            return nullptr;
+        }
+
+        int columns = static_cast<int>(m_terminals.size()) + 1; // incl dependent variable
+        int totalCases = m_fitnessCases.size() / columns;
+        auto loadCase = [&](std::vector<double>& caseTerminals, int i)
+        {
+            auto begin = m_fitnessCases.begin() + i*columns;
+            std::copy(begin, begin + columns - 1, caseTerminals.begin());
+        };
+
+        // Evaluates the S-expression over chunks of rows, split across the threads of the row partition if
+        // given, and otherwise one after another with the given terminals. The chunks are the same either way,
+        // and are reduced in order, so the tuned constants don't depend on the number of threads.
+        auto mapRows = [&](auto evaluate)
+        {
+            using Result = decltype(evaluate(*tree, terminals, 0, 0));
+            if (rows)
+            {
+                return rows->Map<Result>(*tree, totalCases, evaluate);
+            }
+
+            std::vector<Result> results;
+            tree->Rebind(m_terminals.data(), terminals.data(), m_terminals.size());
+            for (int begin = 0; begin < totalCases; begin += RowPartition::ChunkRows)
+            {
+                results.push_back(evaluate(static_cast<const INode&>(*tree), terminals, begin,
+                        std::min(totalCases, begin + RowPartition::ChunkRows)));
+            }
+            tree->Rebind(terminals.data(), m_terminals.data(), m_terminals.size());
+            return results;
+        };
+
+        // The parameters are the constants, followed by the intercept and slope if linearly scaled
+        int numConstants = static_cast<int>(constants.size());
+        int numParams = numConstants + (m_linearScaling ? 2 : 0);
+        Eigen::VectorXd params(numParams);
+        Eigen::VectorXd outputs(totalCases);
+        Eigen::VectorXd expected(totalCases);
+        for (int j = 0; j < numConstants; ++j)
+        {
+            params(j) = constants[j]->Value();
+        }
+        auto chunkOutputs = mapRows([&](const INode& copy, std::vector<double>& caseTerminals, int begin, int end)
+        {
+            std::vector<double> chunk;
+            for (int i = begin; i < end; ++i)
+            {
+                loadCase(caseTerminals, i);
+                chunk.push_back(copy.Evaluate());
+            }
+            return chunk;
+        });
+        for (int i = 0; i < totalCases; ++i)
+        {
+            expected(i) = m_fitnessCases[(i + 1)*columns - 1];
+            outputs(i) = chunkOutputs[i / RowPartition::ChunkRows][i % RowPartition::ChunkRows];
+        }
+        if (m_linearScaling)
+        {
+            // start from the least-squares fit of the untuned output
+            Eigen::VectorXd deviations = outputs.array() - outputs.mean();
+            double sqDeviations = deviations.squaredNorm();
+            params(numConstants + 1) = sqDeviations > 0.0 ? deviations.dot(expected) / sqDeviations : 0.0;
+            params(numConstants) = expected.mean() - params(numConstants + 1) * outputs.mean();
+            outputs = params(numConstants) + params(numConstants + 1) * outputs.array();
+        }
+
+        auto setConstants = [&](const Eigen::VectorXd& p)
+        {
+            for (int j = 0; j < numConstants; ++j)
+            {
+                constants[j]->SetValue(p(j));
+            }
+        };
+
+        // the (scaled) output of the S-expression for a fitness case
+        auto scale = [&](const Eigen::VectorXd& p, double output)
+        {
+            return m_linearScaling ? p(numConstants) + p(numConstants + 1) * output : output;
+        };
+
+        // the sum of the squared residuals (the expected value less the scaled output) over the fitness cases
+        auto sumOfSqResiduals = [&](const Eigen::VectorXd& p)
+        {
+            setConstants(p);
+            auto chunks = mapRows([&](const INode& copy, std::vector<double>& caseTerminals, int begin, int end)
+            {
+                double sum = 0.0;
+                for (int i = begin; i < end; ++i)
+                {
+                    loadCase(caseTerminals, i);
+                    double residual = expected(i) - scale(p, copy.Evaluate());
+                    sum += residual * residual;
+                }
+                return sum;
+            });
+            return std::accumulate(chunks.begin(), chunks.end(), 0.0);
+        };
+
+        // the Gauss-Newton system J'J and J'r, for the Jacobian J of the scaled output with respect to the
+        // parameters and the residuals r, from one pass per fitness case that differentiates by every constant
+        struct NormalEquations
+        {
+            Eigen::MatrixXd JtJ;
+            Eigen::VectorXd Jtr;
+        };
+        auto normalEquations = [&](const Eigen::VectorXd& p)
+        {
+            setConstants(p);
+            double slope = m_linearScaling ? p(numConstants + 1) : 1.0;
+            auto chunks = mapRows([&](const INode& copy, std::vector<double>& caseTerminals, int begin, int end)
+            {
+                // the copy's constants, in the same order as the parameters
+                std::vector<const INode*> seeds;
+                FindSeeds(&copy, seeds);
+
+                NormalEquations chunk{ Eigen::MatrixXd::Zero(numParams, numParams), Eigen::VectorXd::Zero(numParams) };
+                Eigen::VectorXd gradient(numParams);
+                for (int i = begin; i < end; ++i)
+                {
+                    loadCase(caseTerminals, i);
+                    auto dual = copy.EvaluateDual(seeds);
+                    for (int j = 0; j < numConstants; ++j)
+                    {
+                        gradient(j) = slope * dual.Derivative(j);
+                    }
+                    if (m_linearScaling)
+                    {
+                        gradient(numConstants) = 1.0;
+                        gradient(numConstants + 1) = dual.Value;
+                    }
+                    chunk.JtJ.noalias() += gradient * gradient.transpose();
+                    chunk.Jtr += (expected(i) - scale(p, dual.Value)) * gradient;
+                }
+                return chunk;
+            });
+
+            NormalEquations system{ Eigen::MatrixXd::Zero(numParams, numParams), Eigen::VectorXd::Zero(numParams) };
+            for (const auto& chunk : chunks)
+            {
+                system.JtJ += chunk.JtJ;
+                system.Jtr += chunk.Jtr;
+            }
+            return system;
+        };
+
+        double sumOfSqErrors = (expected - outputs).squaredNorm();
+        double damping = InitialDamping;
+        for (int iteration = 0; iteration < TuningIterations && std::isfinite(sumOfSqErrors); ++iteration)
+        {
+            auto [JtJ, gradient] = normalEquations(params);
+            if (!JtJ.allFinite() || !gradient.allFinite())
+            {
+                break;
+            }
+
+            // increase the damping (towards gradient descent) until a step improves the fit
+            bool improved = false;
+            while (!improved && damping < MaxDamping)
+            {
+                Eigen::MatrixXd damped = JtJ;
+                damped.diagonal() += damping * JtJ.diagonal().cwiseMax(MinCurvature);
+                Eigen::VectorXd trial = params + damped.ldlt().solve(gradient);
+
+                double trialSumOfSqErrors = sumOfSqResiduals(trial);
+                improved = trialSumOfSqErrors < sumOfSqErrors;
+                if (improved)
+                {
+                    params = trial;
+                    sumOfSqErrors = trialSumOfSqErrors;
+                    damping /= 10.0;
+                }
+                else
+                {
+                    damping *= 10.0;
+                }
+            }
+            if (!improved)
+            {
+                break; // converged
+            }
+        }
+
+        // the chromosome re-fits its own scaling, and may not be measured by squared errors
+        setConstants(params);
+        auto tuned = CopyAndEvaluate(std::move(tree), parsimonyCoefficient, std::numeric_limits<double>::max(), 
+                terminals, rows);
+        return tuned->WeightedFitness() < chromosome.WeightedFitness() ? std::move(tuned) : nullptr;
     }
 }
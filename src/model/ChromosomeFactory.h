@@ -4,36 +4,40 @@
 #include <memory>
 #include <string>
 #include "ChromosomeType.h"
+#include "InitialisationMethod.h"
+#include "Genealogy.h"
 #include "IChromosome.h"
+#include "RowPartition.h"
+#include "../utils/ThreadPool.h"
+#include "../PopulationParams.h"
 
 namespace Model
 {
     /**
-     * A singleton factory class to create new Chromosomes of a specified type.
+     * A factory class to create new Chromosomes of a specified type, for a population and any islands or
+     * replicas that share its data.
      */
     class ChromosomeFactory
     {
     public:
         /**
-         * Initialises the factory/singleton
-         * @param type The type of Chromosome to be created by the factory
-         * @param targetSize The number of nodes in the chromosome tree we'd like. The
-         *        number created is not deterministic, so targetSize acts as a minimum.
-         * @param allowedFunctions The functions (types) allowed in the S-expressions
+         * Constructor. The factory holds references to the data below, so mustn't outlive their owner.
+         * @param params The population parameters, which determine the type, initial size and
+         *        allowed functions of the Chromosomes created by the factory
          * @param variables A vector of pointers to the terminals
+         * @param terminalSet The variables that random Chromosomes are built from, and nullptr to denote
+         *        an ephemeral random constant
          * @param fitnessCases The training data
          * @param terminals A vector of the terminals of interest
+         * @param costs The cost of each primitive, by which Chromosomes are penalised instead of by size, 
+         *        or nullptr to penalise size
          */
-        static void Initialise(ChromosomeType type, int targetSize, 
-                const std::vector<FunctionType>& allowedFunctions, 
+        ChromosomeFactory(const PopulationParams& params,
                 const std::vector<double*>& variables,  // TODO: this is probably unecessary
+                const std::vector<double*>& terminalSet,
                 const std::vector<double>& fitnessCases, 
-                std::vector<double>& terminals);
-
-        /**
-         * @return a reerence to the singleton instance
-         */
-        static const ChromosomeFactory& Inst();
+                std::vector<double>& terminals,
+                const CostTable* costs = nullptr);
 
         /**
          * Create a new, random Chromosome
@@ -41,33 +45,124 @@ namespace Model
          */
         std::unique_ptr<IChromosome> CreateRandom(double parsimonyCoefficient) const;
 
+        /**
+         * Creates the random S-expressions of an initial population, across the workers of a pool that each 
+         * have their own random number generator (seeded from the calling thread's).
+         *
+         * If the initialisation method is Ramped, this is ramped half-and-half: the S-expressions are evenly 
+         * split between full and grow trees, and between depths from 2 to that of a full binary tree of twice
+         * the minimum size. Duplicates are detected by hashing and replaced, unless the allowed functions and 
+         * terminals can't make enough unique S-expressions.
+         * @param count The number of S-expressions to create
+         * @param pool The workers to create them across, which mustn't be running another job at the same time
+         * @return the S-expressions, which have not been evaluated
+         */
+        std::vector<std::unique_ptr<INode>> CreateUniqueRandomTrees(int count, Util::ThreadPool& pool) const;
+
         /**
          * Create a Chromosome
          * @param tree The pre-build INode tree for the Chromosome. Ownership of the tree is transferred
          *        to the new Chromosome.
          * @param parsimonyCoefficient The coefficient used to penalise long chromosomes
+         * @param cutoff The weighted fitness the Chromosome must beat to be of any use. Evaluation stops 
+         *        early once it is known not to, in which case the fitness is only a lower bound.
          * @return the new Chromosome
          */
-        std::unique_ptr<IChromosome> CopyAndEvaluate(std::unique_ptr<INode> tree, double parsimonyCoefficient) const;
+        std::unique_ptr<IChromosome> CopyAndEvaluate(std::unique_ptr<INode> tree, double parsimonyCoefficient,
+                double cutoff = std::numeric_limits<double>::max()) const;
+
+        /**
+         * @see CopyAndEvaluate. May be called from several threads at once, provided each has its own terminals.
+         * @param terminals The buffer to evaluate with, the same size as the factory's terminals. The
+         *        S-expression of the new Chromosome still points to the factory's terminals.
+         * @param rows If set, the fitness cases are split across its threads, and the terminals are unused
+         */
+        std::unique_ptr<IChromosome> CopyAndEvaluate(std::unique_ptr<INode> tree, double parsimonyCoefficient,
+                double cutoff, std::vector<double>& terminals, const RowPartition* rows = nullptr) const;
+
+        /**
+         * Evaluates a Chromosome that an operator has modified. May be called from several threads at once,
+         * provided each has its own terminals.
+         * @param chromosome The modified Chromosome, which is consumed
+         * @param parsimonyCoefficient The coefficient used to penalise long chromosomes
+         * @param terminals The buffer to evaluate with, the same size as the factory's terminals. The
+         *        S-expression of the evaluated Chromosome still points to the factory's terminals.
+         * @param cutoff The weighted fitness the Chromosome must beat to be of any use
+         * @param rows If set, the fitness cases are split across its threads, and the terminals are unused
+         * @return the evaluated Chromosome
+         */
+        std::unique_ptr<IChromosome> Evaluate(std::unique_ptr<IChromosome> chromosome, double parsimonyCoefficient,
+                std::vector<double>& terminals, double cutoff = std::numeric_limits<double>::max(),
+                const RowPartition* rows = nullptr) const;
+
+        /**
+         * Create a Chromosome without evaluating it, such as when it is culled to control bloat
+         * @param tree The pre-build INode tree for the Chromosome. Ownership of the tree is transferred
+         *        to the new Chromosome.
+         * @param parsimonyCoefficient The coefficient used to penalise long chromosomes
+         * @return the new Chromosome, with the worst possible fitness
+         */
+        std::unique_ptr<IChromosome> CreateUnevaluated(std::unique_ptr<INode> tree, double parsimonyCoefficient) const;
+
+        /**
+         * Tunes the constants of a Chromosome to the fitness cases, by Levenberg-Marquardt. The Jacobian
+         * is found by forward-mode automatic differentiation of the S-expression, with respect to every
+         * constant in one pass per fitness case.
+         * Only Normal Chromosomes are tuned, since the least-squares fit of TimeSeries Chromosomes already
+         * scales each of their terms.
+         * @param chromosome The Chromosome to tune
+         * @param parsimonyCoefficient The coefficient used to penalise long chromosomes
+         * @param terminals The buffer to evaluate with, the same size as the factory's terminals. May be called 
+         *        from several threads at once, provided each has its own.
+         * @param rows If set, the fitness cases of each iteration are split across its threads, and the
+         *        terminals are unused
+         * @return a tuned copy of the Chromosome, or nullptr if tuning failed to improve its weighted fitness
+         */
+        std::unique_ptr<IChromosome> TuneConstants(const IChromosome& chromosome, double parsimonyCoefficient,
+                std::vector<double>& terminals, const RowPartition* rows = nullptr) const;
 
     private:
-        
         /**
-         * Constructor
+         * @return a new, random S-expression
+         * @param targetSize The minimum size of the S-expression
+         * @param full If true, the tree is built from functions only (other than its leaves)
+         */
+        std::unique_ptr<INode> CreateRandomTree(int targetSize, bool full) const;
+
+        /**
+         * @return a new, random S-expression no deeper than the given depth
+         * @param depth The depth of the deepest nodes, where the root is at depth 0
+         * @param full If true, every branch is built from functions down to the depth
+         */
+        std::unique_ptr<INode> CreateRandomTreeToDepth(int depth, bool full) const;
+
+        /**
+         * @return the greatest depth that ramped initialisation builds S-expressions to
          */
-        ChromosomeFactory(ChromosomeType type, int targetSize, const std::vector<FunctionType>& allowedFunctions, 
-                    const std::vector<double*>& variables, const std::vector<double>& fitnessCases, 
-                    std::vector<double>& terminals);
+        int MaxRampedDepth() const;
+
+        /**
+         * Uses interval arithmetic over the range of each variable to replace provably constant
+         * subtrees with Constants, before any fitness case is evaluated.
+         * @param tree The S-expression to simplify
+         * @return false if the S-expression is provably non-finite for every fitness case
+         */
+        bool Simplify(std::unique_ptr<INode>& tree) const;
 
         // TODO: can these be const?
         const ChromosomeType m_type = ChromosomeType::Normal; //<
         const int m_targetSize;
+        const InitialisationMethod m_initialisation; ///< How random S-expressions are created
         const std::vector<FunctionType> m_allowedFunctions;
         const std::vector<double*>& m_variables;
+        const std::vector<double*>& m_terminalSet; ///< The variables, and nullptr to denote an ephemeral random constant
         const std::vector<double>& m_fitnessCases;
         std::vector<double>& m_terminals;
-
-        static std::unique_ptr<ChromosomeFactory> s_instance;
+        const bool m_intervalAnalysis; ///< Whether to Simplify S-expressions before evaluation
+        VariableRanges m_ranges; ///< The range of each variable over the fitness cases
+        const bool m_linearScaling; ///< Whether Normal Chromosomes scale their output to fit the fitness cases
+        const CostTable* m_costs; ///< The cost of each primitive, or nullptr if Chromosomes are penalised by size
+        std::shared_ptr<Genealogy> m_genealogy; ///< The genealogy of GeometricSemantic Chromosomes, or nullptr
     };
 }
 #endif
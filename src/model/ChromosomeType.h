@@ -7,7 +7,8 @@ namespace Model
      */
     enum class ChromosomeType
     {
-        Normal = 0, ///< general purpose chromosomes for fitting 
-        TimeSeries  ///< auto-regressive, non-linear, with least-squares-fit coefficients
+        Normal = 0,       ///< general purpose chromosomes for fitting 
+        TimeSeries,       ///< auto-regressive, non-linear, with least-squares-fit coefficients
+        GeometricSemantic ///< general purpose fitting, by geometric semantic operators upon the outputs of chromosomes
     };
 }
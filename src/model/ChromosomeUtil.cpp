@@ -7,13 +7,20 @@ namespace Model::ChromosomeUtil
 {
     Util::UniformRandomGenerator<int, std::uniform_int_distribution<int>>& RandInt()
     {
-        static Util::UniformRandomGenerator<int, std::uniform_int_distribution<int>> randInt(0, 1);
+        thread_local Util::UniformRandomGenerator<int, std::uniform_int_distribution<int>> randInt(0, 1);
         return randInt;
     }
 
+    Util::UniformRandomGenerator<double>& RandReal()
+    {
+        thread_local Util::UniformRandomGenerator<double> randReal(-1.0, 1.0);
+        return randReal;
+    }
+
     void SetSeed(int seed)
     {
         RandInt().SetSeed(seed);
+        RandReal().SetSeed(seed);
     }
 
     bool IsTerminal(const std::unique_ptr<INode>& gene)
@@ -32,7 +39,79 @@ namespace Model::ChromosomeUtil
         while (func->LacksBreadth())
         {
             auto index = RandomIndex(variables.size());
-            func->AddChild(FunctionFactory::Create(variables[index]));
+            func->AddChild(FunctionFactory::Create(variables, index));
+        }
+    }
+
+    void GrowTree(Model::INode* root, int targetSize, bool full, 
+            const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables)
+    {
+        std::vector<INode*> functions { root }; // every function in the tree
+        std::vector<INode*> open { root };      // the functions that may take more children
+        auto next = 0u; // the function being filled, when building a full tree
+
+        for (int count = 1; count < targetSize && next < open.size(); ++count)
+        {
+            std::unique_ptr<INode> newNode;
+            if (full || RandInt().GetInRange(0, 1) == 0)
+            {
+                newNode = FunctionFactory::Create(allowedFunctions[RandomIndex(allowedFunctions.size())]);
+            }
+            else
+            {
+                newNode = FunctionFactory::Create(variables, RandomIndex(variables.size()));
+            }
+            auto isFunction = !IsTerminal(newNode);
+            auto node = newNode.get();
+
+            auto index = full ? next : next + RandomIndex(open.size() - next);
+            auto parent = open[index];
+            parent->AddChild(std::move(newNode));
+
+            if (full ? !parent->LacksBreadth() : parent->NumberOfChildren() == parent->MaxChildren())
+            {
+                // the parent is done with; for grow, move it out of the range that's drawn from
+                std::swap(open[index], open[next]);
+                ++next;
+            }
+            if (isFunction)
+            {
+                functions.push_back(node);
+                open.push_back(node);
+            }
+        }
+
+        // Make sure none of the leaf nodes are functions, and that functions have
+        // their minimum number of children.
+        for (auto func : functions)
+        {
+            FillFunction(func, variables);
+        }
+    }
+
+    void GrowTreeToDepth(Model::INode* root, int depth, bool full, 
+            const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables)
+    {
+        std::vector<std::pair<INode*, int>> open { { root, 0 } }; // functions to fill, and their depths
+        while (!open.empty())
+        {
+            auto [func, level] = open.back();
+            open.pop_back();
+            while (func->LacksBreadth())
+            {
+                bool function = level + 1 < depth && !allowedFunctions.empty() 
+                    && (full || RandInt().GetInRange(0, 1) == 0);
+                if (function)
+                {
+                    auto child = FunctionFactory::Create(allowedFunctions[RandomIndex(allowedFunctions.size())]);
+                    open.emplace_back(child.get(), level + 1);
+                    func->AddChild(std::move(child));
+                }
+                else
+                {
+                    func->AddChild(FunctionFactory::Create(variables, RandomIndex(variables.size())));
+                }
+            }
         }
     }
 }
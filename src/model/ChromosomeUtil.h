@@ -8,22 +8,30 @@
 namespace Model
 {
     class INode;
+    enum class FunctionType;
 
     namespace ChromosomeUtil
     {
         /**
-         * A random integer generator for reuse in the methods below
+         * A random integer generator for reuse in the methods below. Each thread has its own generator, which
+         * a population reseeds from its own seeds before each use, so populations don't share random state.
          */
         Util::UniformRandomGenerator<int, std::uniform_int_distribution<int>>& RandInt();
 
         /**
-         * Sets the seed of the random number generator.
+         * A random real number generator, used for the values of ephemeral random constants. Each thread
+         * has its own generator.
+         */
+        Util::UniformRandomGenerator<double>& RandReal();
+
+        /**
+         * Sets the seed of the calling thread's random number generators.
          */
         void SetSeed(int seed);
 
         /**
         * @param gene The S-expression gene to inspect
-        * @return true if the gene is a Terminal (not a Function)
+        * @return true if the gene is a Terminal or Constant (not a Function)
         */
         bool IsTerminal(const std::unique_ptr<INode>& gene);
 
@@ -39,6 +47,33 @@ namespace Model
          * @param func The function to fill.
          */
         void FillFunction(Model::INode* func, const std::vector<double*>& variables);
+
+        /**
+         * Adds random nodes to a function until the tree reaches the target size, then fills each function
+         * with terminals. Functions that can take more children are tracked, so this takes linear time.
+         * @param root The function at the root of the tree.
+         * @param targetSize The number of nodes to add before filling functions with terminals.
+         * @param full If true, only functions are added, and each is given its minimum number of children 
+         *        (breadth-first) before the next. Otherwise nodes are equally likely to be functions or 
+         *        terminals, and are added to random functions.
+         * @param allowedFunctions The set of functions that may be added
+         * @param variables The set of terminals that may be added
+         */
+        void GrowTree(Model::INode* root, int targetSize, bool full, 
+                const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables);
+
+        /**
+         * Adds random nodes to a function, giving each function its minimum number of children, until every
+         * branch ends in a terminal no deeper than the given depth.
+         * @param root The function at the root of the tree, which is at depth 0
+         * @param depth The depth of the deepest terminals
+         * @param full If true, every node above the depth is a function, so every branch reaches it. Otherwise
+         *        nodes above it are equally likely to be functions or terminals.
+         * @param allowedFunctions The set of functions that may be added
+         * @param variables The set of terminals that may be added
+         */
+        void GrowTreeToDepth(Model::INode* root, int depth, bool full, 
+                const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables);
     }
 }
 #endif
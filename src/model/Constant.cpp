@@ -0,0 +1,126 @@
+#include "Constant.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace Model
+{
+    Constant::Constant(double value)
+        : m_value(value)
+    {
+    }
+
+    Constant::Constant(const Constant& other)
+        : m_value(other.m_value)
+    {
+    }
+
+    double Constant::Evaluate() const
+    {
+        return m_value;
+    }
+
+    Util::Interval Constant::EvaluateInterval(const VariableRanges& ranges) const
+    {
+        return Util::Interval::Point(m_value);
+    }
+
+    Util::Dual Constant::EvaluateDual(const std::vector<const INode*>& seeds) const
+    {
+        auto seed = std::find(seeds.begin(), seeds.end(), this);
+        return seed != seeds.end() ? Util::Dual::Seed(m_value, seed - seeds.begin(), seeds.size()) : Util::Dual::Constant(m_value);
+    }
+
+    double Constant::Value() const
+    {
+        return m_value;
+    }
+
+    void Constant::SetValue(double value)
+    {
+        m_value = value;
+    }
+
+    std::string Constant::ToString() const
+    {
+        return Format(m_value);
+    }
+
+    std::string Constant::Format(double value)
+    {
+        std::string text;
+        for (int precision = std::numeric_limits<double>::digits10;
+                precision <= std::numeric_limits<double>::max_digits10; ++precision)
+        {
+            std::stringstream out;
+            out.precision(precision);
+            out << value;
+            text = out.str();
+
+            double parsed;
+            std::stringstream in(text);
+            if (in >> parsed && parsed == value)
+            {
+                break;
+            }
+        }
+        return text;
+    }
+
+    bool Constant::MoveChildrenTo(std::unique_ptr<INode>& other)
+    {
+        throw std::logic_error("Constants should not be swapped directly");
+    }
+
+    bool Constant::AddChild(std::unique_ptr<INode> child)
+    {
+        throw std::logic_error("Constants cannot have children");
+    }
+
+    int Constant::NumberOfChildren() const
+    {
+        return 0;
+    }
+
+    const std::vector<std::unique_ptr<INode>>& Constant::GetChildren() const
+    {
+        throw std::logic_error("Constants do not have any children.");
+    }
+
+    int Constant::MaxChildren() const
+    {
+        return 0;
+    }
+
+    int Constant::Size() const
+    {
+        return 1;
+    }
+
+    std::unique_ptr<INode>& Constant::Get(int index, std::unique_ptr<INode>& ptr)
+    {
+        if (index != 0)
+        {
+            throw std::out_of_range("The unique ptr for a Constant should be obtained from a Function.");
+        }
+        return ptr;
+    }
+
+    std::unique_ptr<INode> Constant::Clone() const
+    {
+        return std::make_unique<Constant>(*this);
+    }
+
+    std::size_t Constant::Hash() const
+    {
+        return std::hash<double>{}(m_value);
+    }
+
+    std::string Constant::GetSymbol() const
+    {
+        return ToString();
+    }
+}
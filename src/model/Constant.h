@@ -0,0 +1,115 @@
+#ifndef Constant_H
+#define Constant_H
+
+#include <memory>
+#include <vector>
+
+#include "INode.h"
+
+namespace Model
+{
+    /**
+     * A leaf node of the genetic programming tree/model that always evaluates to the same value.
+     */
+    class Constant : public INode
+    {
+    public:
+        /**
+         * Constructor
+         * @param value The value of the constant.
+         */
+        Constant(double value);
+
+        Constant(const Constant& other);
+
+        /**
+         * @see INode::Evaluate
+         */
+        double Evaluate() const override;
+
+        /**
+         * @see INode::EvaluateInterval
+         */
+        Util::Interval EvaluateInterval(const VariableRanges& ranges) const override;
+
+        /**
+         * @see INode::EvaluateDual
+         */
+        Util::Dual EvaluateDual(const std::vector<const INode*>& seeds) const override;
+
+        /**
+         * @return the value of the constant
+         */
+        double Value() const;
+
+        /**
+         * Changes the value of the constant, e.g. when tuning it to fit the fitness cases
+         */
+        void SetValue(double value);
+
+        /**
+         * @see INode::ToString
+         */
+        std::string ToString() const override;
+
+        /**
+         * @return the shortest decimal that reads back as exactly the same value, so a printed S-expression
+         *         reproduces its fitness
+         */
+        static std::string Format(double value);
+
+        /**
+         * @see INode::MoveChildrenTo
+         */
+        bool MoveChildrenTo(std::unique_ptr<INode>& other) override;
+
+        /**
+         * @see INode::AddChild()
+         */
+        bool AddChild(std::unique_ptr<INode> child) override;
+
+        /**
+         * @see INode::NumberOfChildren()
+         */
+        int NumberOfChildren() const override;
+
+        /**
+         * @see INode::GetChildren
+         */
+        const std::vector<std::unique_ptr<INode>>& GetChildren() const override;
+
+        /**
+         * @see INode::MaxChildren()
+         */
+        int MaxChildren() const override;
+
+        /**
+         * @see INode::Size()
+         */
+        int Size() const override;
+
+        /**
+         * @see INode::Get
+         */
+        std::unique_ptr<INode>& Get(int index, std::unique_ptr<INode>& ptr) override;
+
+        /**
+         * @see INode::Clone
+         */
+        std::unique_ptr<INode> Clone() const override;
+
+        /**
+         * @see INode::Hash
+         */
+        std::size_t Hash() const override;
+
+    private:
+        /**
+         * @see INode::GetSymbol
+         */
+        std::string GetSymbol() const override;
+
+        double m_value; ///< The value of the constant
+    };
+}
+#endif
@@ -0,0 +1,111 @@
+#include "CostTable.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include "Constant.h"
+#include "FunctionFactory.h"
+
+namespace
+{
+    // Calibration settings
+    const int CalibrationRepeats = 5;          // the fastest of the repeats is taken, to discount interruptions
+    const int CalibrationEvaluations = 20000;  // evaluations per repeat
+    const int CalibrationInputs = 16;          // leaves cycle through this many values in [0.5, 2.5), inside
+                                               // the domain of every function
+
+    /**
+     * Makes the compiler produce a value, as if it were read, without storing it anywhere
+     */
+    void DoNotOptimize(const double& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile double sink;
+        sink = value;
+#endif
+    }
+
+    /**
+     * Times the evaluation of a node whose leaves are the given constants
+     * @return the fastest time per evaluation, in seconds
+     */
+    double TimePerEvaluation(const Model::INode& node, const std::vector<Model::Constant*>& leaves)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        double fastest = std::numeric_limits<double>::max();
+        for (int repeat = 0; repeat < CalibrationRepeats; ++repeat)
+        {
+            double sum = 0.0;
+            auto start = Clock::now();
+            for (int i = 0; i < CalibrationEvaluations; ++i)
+            {
+                double input = 0.5 + (i % CalibrationInputs) * 2.0 / CalibrationInputs;
+                for (auto leaf : leaves)
+                {
+                    leaf->SetValue(input);
+                }
+                sum += node.Evaluate();
+            }
+            DoNotOptimize(sum); // so the evaluations can't be optimised away, or moved out of the timing
+            std::chrono::duration<double> elapsed = Clock::now() - start;
+            fastest = std::min(fastest, elapsed.count() / CalibrationEvaluations);
+        }
+        return fastest;
+    }
+}
+
+namespace Model
+{
+    CostTable::CostTable(const std::map<FunctionType, double>& functionCosts, double leafCost)
+        : m_functionCosts(functionCosts)
+        , m_leafCost(leafCost)
+    {
+    }
+
+    CostTable CostTable::Calibrate(const std::vector<FunctionType>& functions)
+    {
+        // the time to evaluate a lone leaf, which is also the overhead included in every other timing
+        Constant leaf(1.0);
+        auto leafTime = TimePerEvaluation(leaf, { &leaf });
+
+        // the time for each function alone, less that of evaluating its (minimum number of) leaves
+        std::map<FunctionType, double> times;
+        for (auto type : functions)
+        {
+            auto function = FunctionFactory::Create(type);
+            std::vector<Constant*> leaves;
+            while (function->LacksBreadth())
+            {
+                auto child = std::make_unique<Constant>(1.0);
+                leaves.push_back(child.get());
+                function->AddChild(std::move(child));
+            }
+            auto time = TimePerEvaluation(*function, leaves) - leaves.size() * leafTime;
+            times[type] = std::max(time, std::numeric_limits<double>::min());
+        }
+        if (times.empty())
+        {
+            return CostTable();
+        }
+
+        auto addition = times.find(FunctionType::Addition);
+        auto unit = addition != times.end() ? addition->second
+            : std::min_element(times.begin(), times.end(), [](auto& a, auto& b) { return a.second < b.second; })->second;
+
+        std::map<FunctionType, double> costs;
+        for (auto [type, time] : times)
+        {
+            costs[type] = time / unit;
+        }
+        return CostTable(costs, leafTime / unit);
+    }
+
+    double CostTable::Of(FunctionType type) const
+    {
+        auto cost = m_functionCosts.find(type);
+        return cost != m_functionCosts.end() ? cost->second : 1.0;
+    }
+}
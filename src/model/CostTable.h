@@ -0,0 +1,57 @@
+#ifndef CostTable_H
+#define CostTable_H
+
+#include <map>
+#include <vector>
+
+namespace Model
+{
+    enum class FunctionType;
+
+    /**
+     * The estimated cost of evaluating each primitive, in units of the cost of an addition. Used to
+     * penalise S-expressions by how expensive they are to evaluate, rather than by how many nodes they have.
+     *
+     * A default constructed table gives every primitive a cost of 1, such that the cost of an S-expression
+     * is its size.
+     */
+    class CostTable
+    {
+    public:
+        /**
+         * Constructor - every primitive costs 1
+         */
+        CostTable() = default;
+
+        /**
+         * Constructor
+         * @param functionCosts The cost of each function. Functions not listed cost 1.
+         * @param leafCost The cost of a terminal or constant
+         */
+        explicit CostTable(const std::map<FunctionType, double>& functionCosts, double leafCost = 1.0);
+
+        /**
+         * Measures the cost of each function by timing its evaluation over terminals, relative to
+         * addition (or the cheapest function, if addition isn't among them).
+         * @param functions The functions to measure
+         * @return the measured costs
+         */
+        static CostTable Calibrate(const std::vector<FunctionType>& functions);
+
+        /**
+         * @return the cost of evaluating a function node, excluding its children
+         */
+        double Of(FunctionType type) const;
+
+        /**
+         * @return the cost of evaluating a terminal or constant
+         */
+        double Leaf() const { return m_leafCost; }
+
+    private:
+        std::map<FunctionType, double> m_functionCosts; ///< The cost of each function, if not 1
+        double m_leafCost = 1.0; ///< The cost of a terminal or constant
+    };
+}
+
+#endif
@@ -1,27 +1,38 @@
 #include "Function.h"
 
+#include <algorithm>
 #include <cassert>
 #include <numeric>
 #include <sstream>
 #include <stdexcept>
+#include "Constant.h"
 
 namespace Model
 {
-    Function::Function(std::function<double(const ChildNodes&)> func,
+    Function::Function(FunctionType type,
+                std::function<double(const ChildNodes&)> func,
+                std::function<Util::Interval(const ChildIntervals&)> intervalFunc,
+                std::function<Util::Dual(const ChildDuals&)> dualFunc,
                 const std::string& symbol,
                 int minChildren /*= 1*/,
                 int maxChildren /*= std::numeric_limits<int>::max()*/)
-        : MinAllowedChildren(minChildren)
+        : m_type(type)
+        , MinAllowedChildren(minChildren)
         , MaxAllowedChildren(maxChildren)
         , m_func(func)
+        , m_intervalFunc(intervalFunc)
+        , m_dualFunc(dualFunc)
         , m_symbol(symbol)
     {
     }
 
     Function::Function(const Function& other)
-        : MinAllowedChildren(other.MinAllowedChildren)
+        : m_type(other.m_type)
+        , MinAllowedChildren(other.MinAllowedChildren)
         , MaxAllowedChildren(other.MaxAllowedChildren)
         , m_func(other.m_func)
+        , m_intervalFunc(other.m_intervalFunc)
+        , m_dualFunc(other.m_dualFunc)
         , m_symbol(other.m_symbol)
     {
         for (auto& child : other.m_children)
@@ -35,6 +46,42 @@ namespace Model
         return m_func(m_children);
     }
 
+    Util::Interval Function::EvaluateInterval(const VariableRanges& ranges) const
+    {
+        ChildIntervals bounds;
+        for (auto& child : m_children)
+        {
+            bounds.push_back(child->EvaluateInterval(ranges));
+        }
+        return m_intervalFunc(bounds);
+    }
+
+    Util::Dual Function::EvaluateDual(const std::vector<const INode*>& seeds) const
+    {
+        ChildDuals duals;
+        for (auto& child : m_children)
+        {
+            duals.push_back(child->EvaluateDual(seeds));
+        }
+        return m_dualFunc(duals);
+    }
+
+    Util::Interval Function::FoldConstants(const VariableRanges& ranges)
+    {
+        ChildIntervals bounds;
+        for (auto& child : m_children)
+        {
+            auto bound = child->FoldConstants(ranges);
+            if (bound.IsPoint() && child->MaxChildren() != 0)
+            {
+                // the subtree always evaluates to the same value, so needn't be evaluated at all
+                child = std::make_unique<Constant>(bound.Lower);
+            }
+            bounds.push_back(bound);
+        }
+        return m_intervalFunc(bounds);
+    }
+
     std::string Function::ToString() const
     {
         std::stringstream out;
@@ -115,11 +162,59 @@ namespace Model
         throw std::out_of_range("Index out of range in Function::Get. Index: " + std::to_string(originalIndex) + ", Size(): " + std::to_string(Size()));
     }
 
+    void Function::IndexNodes(std::unique_ptr<INode>& ptr, NodeIndex& index, int depth)
+    {
+        auto position = index.Slots.size();
+        index.Slots.push_back(&ptr);
+        index.Sizes.push_back(1);
+        index.Depths.push_back(depth);
+        index.Heights.push_back(0);
+
+        int height = 0;
+        for (auto& child : m_children)
+        {
+            auto childPosition = index.Slots.size();
+            child->IndexNodes(child, index, depth + 1);
+            height = std::max(height, index.Heights[childPosition] + 1);
+        }
+        index.Sizes[position] = static_cast<int>(index.Slots.size() - position);
+        index.Heights[position] = height;
+    }
+
     std::unique_ptr<INode> Function::Clone() const
     {
         return std::make_unique<Function>(*this);
     }
 
+    std::size_t Function::Hash() const
+    {
+        // combine the hashes of the symbol and children, as per boost::hash_combine
+        auto hash = std::hash<std::string>{}(m_symbol);
+        for (const auto& child : m_children)
+        {
+            hash ^= child->Hash() + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+
+    double Function::Cost(const CostTable& costs) const
+    {
+        auto cost = costs.Of(m_type);
+        for (const auto& child : m_children)
+        {
+            cost += child->Cost(costs);
+        }
+        return cost;
+    }
+
+    void Function::Rebind(const double* from, const double* to, std::size_t count)
+    {
+        for (auto& child : m_children)
+        {
+            child->Rebind(from, to, count);
+        }
+    }
+
     bool Function::LacksBreadth() const
     {
         return NumberOfChildren() <  MinAllowedChildren;
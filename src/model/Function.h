@@ -10,7 +10,11 @@
 
 namespace Model
 {
+    enum class FunctionType;
+
     typedef std::vector<std::unique_ptr<INode>> ChildNodes;
+    typedef std::vector<Util::Interval> ChildIntervals;
+    typedef std::vector<Util::Dual> ChildDuals;
 
     /**
      * An interface Node of the genetic programming tree/model.
@@ -20,10 +24,16 @@ namespace Model
     public:
         /**
          * Constructor
+         * @param type The type of function, by which its cost is estimated
          * @param func The mathematical function to call upon the child nodes
+         * @param intervalFunc The interval extension of func, called upon the bounds of the child nodes
+         * @param dualFunc The extension of func to dual numbers, which also yields its derivative
          * @param maxChildren The max legal number of children for the function
          */
-        Function(std::function<double(const ChildNodes&)> func,
+        Function(FunctionType type,
+                std::function<double(const ChildNodes&)> func,
+                std::function<Util::Interval(const ChildIntervals&)> intervalFunc,
+                std::function<Util::Dual(const ChildDuals&)> dualFunc,
                 const std::string& symbol,
                 int minChildren = 1,
                 int maxChildren = std::numeric_limits<int>::max());
@@ -35,6 +45,21 @@ namespace Model
          */
         double Evaluate() const override;
 
+        /**
+         * @see INode::EvaluateInterval
+         */
+        Util::Interval EvaluateInterval(const VariableRanges& ranges) const override;
+
+        /**
+         * @see INode::EvaluateDual
+         */
+        Util::Dual EvaluateDual(const std::vector<const INode*>& seeds) const override;
+
+        /**
+         * @see INode::FoldConstants
+         */
+        Util::Interval FoldConstants(const VariableRanges& ranges) override;
+
         /**
          * @see INode::ToString
          */
@@ -75,11 +100,31 @@ namespace Model
          */
         std::unique_ptr<INode>& Get(int index, std::unique_ptr<INode>& ptr) override;
 
+        /**
+         * @see INode::IndexNodes
+         */
+        void IndexNodes(std::unique_ptr<INode>& ptr, NodeIndex& index, int depth) override;
+
         /**
          * @see INode::Clone
          */
         std::unique_ptr<INode> Clone() const override;
 
+        /**
+         * @see INode::Hash
+         */
+        std::size_t Hash() const override;
+
+        /**
+         * @see INode::Cost
+         */
+        double Cost(const CostTable& costs) const override;
+
+        /**
+         * @see INode::Rebind
+         */
+        void Rebind(const double* from, const double* to, std::size_t count) override;
+
         /**
          * returns true if the number of children is less than the minimum required
          */
@@ -92,9 +137,12 @@ namespace Model
         std::string GetSymbol() const override;
 
         ChildNodes m_children;
+        const FunctionType m_type; ///< The type of function
         const int MinAllowedChildren;
         const int MaxAllowedChildren;
         const std::function<double(const ChildNodes&)> m_func;
+        const std::function<Util::Interval(const ChildIntervals&)> m_intervalFunc; ///< Bounds m_func over ranges of its inputs
+        const std::function<Util::Dual(const ChildDuals&)> m_dualFunc; ///< Differentiates m_func, by the chain rule
         const std::string m_symbol; ///< A symbolic representation of the function
     };
 }
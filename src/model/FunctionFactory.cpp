@@ -1,8 +1,11 @@
 #include "FunctionFactory.h"
 
+#include <algorithm>
 #include <cmath>
 #include <numeric>
 #include <stdexcept>
+#include "ChromosomeUtil.h"
+#include "Constant.h"
 #include "Function.h"
 #include "Terminal.h"
 
@@ -19,6 +22,7 @@ namespace
     const std::string Log = "Logarithm";
 
     const double Threshold = 0.001; // A threshold used to prevent infty for division, sqrt, log, etc.
+    const double ConstantRange = 1.0; // Ephemeral random constants are drawn uniformly from [-ConstantRange, ConstantRange]
 }
 
 namespace Model
@@ -50,9 +54,26 @@ namespace Model
         }
     }
 
-    std::unique_ptr<INode> FunctionFactory::Create(const double* variable)
+    std::unique_ptr<INode> FunctionFactory::Create(const double* variable, std::string symbol)
     {
-        return std::make_unique<Terminal>(variable);
+        if (variable == nullptr)
+        {
+            // an ephemeral random constant, whose value is fixed upon creation
+            return std::make_unique<Constant>(ChromosomeUtil::RandReal().GetInRange(-ConstantRange, ConstantRange));
+        }
+        return std::make_unique<Terminal>(variable, std::move(symbol));
+    }
+
+    std::unique_ptr<INode> FunctionFactory::Create(const std::vector<double*>& variables, int index)
+    {
+        auto variable = variables[index];
+        return Create(variable, variable ? VariableSymbol(index) : std::string());
+    }
+
+    std::string FunctionFactory::VariableSymbol(int index)
+    {
+        std::string symbol(1, static_cast<char>('a' + index % 26));
+        return index < 26 ? symbol : symbol + std::to_string(index / 26);
     }
 
     std::string FunctionFactory::AsString(const FunctionType& type)
@@ -137,7 +158,25 @@ namespace Model
             }
             return result;
         };
-        return std::make_unique<Function>(func, "+", 2);
+        auto bound = [](const ChildIntervals& children) -> Util::Interval
+        {
+            auto result = Util::Interval::Point(0.0);
+            for (auto& child : children)
+            {
+                result = result + child;
+            }
+            return result;
+        };
+        auto dual = [](const ChildDuals& children) -> Util::Dual
+        {
+            auto result = Util::Dual::Constant(0.0);
+            for (auto& child : children)
+            {
+                result = result + child;
+            }
+            return result;
+        };
+        return std::make_unique<Function>(FunctionType::Addition, func, bound, dual, "+", 2);
     }
 
     std::unique_ptr<INode> FunctionFactory::CreateSubtraction()
@@ -151,7 +190,25 @@ namespace Model
             }
             return result;
         };
-        return std::make_unique<Function>(func, "-", 2);
+        auto bound = [](const ChildIntervals& children) -> Util::Interval
+        {
+            auto result = children.empty() ? Util::Interval::Point(0.0) : children[0];
+            for (auto i = 1u; i < children.size(); ++i)
+            {
+                result = result - children[i];
+            }
+            return result;
+        };
+        auto dual = [](const ChildDuals& children) -> Util::Dual
+        {
+            auto result = children.empty() ? Util::Dual::Constant(0.0) : children[0];
+            for (auto i = 1u; i < children.size(); ++i)
+            {
+                result = result - children[i];
+            }
+            return result;
+        };
+        return std::make_unique<Function>(FunctionType::Subtraction, func, bound, dual, "-", 2);
     }
 
 
@@ -166,7 +223,25 @@ namespace Model
             }
             return result;
         };
-        return std::make_unique<Function>(func, "*", 2);
+        auto bound = [](const ChildIntervals& children) -> Util::Interval
+        {
+            auto result = Util::Interval::Point(1.0);
+            for (auto& child : children)
+            {
+                result = result * child;
+            }
+            return result;
+        };
+        auto dual = [](const ChildDuals& children) -> Util::Dual
+        {
+            auto result = Util::Dual::Constant(1.0);
+            for (auto& child : children)
+            {
+                result = result * child;
+            }
+            return result;
+        };
+        return std::make_unique<Function>(FunctionType::Multiplication, func, bound, dual, "*", 2);
     }
 
     std::unique_ptr<INode> FunctionFactory::CreateDivision()
@@ -189,7 +264,51 @@ namespace Model
             }
             throw std::logic_error("A division function must have no more than 2 children.");
         };
-        return std::make_unique<Function>(func, "/", 2, 2);
+        auto bound = [](const ChildIntervals& children) -> Util::Interval
+        {
+            if (children.size() == 1)
+            {
+                return children[0];
+            }
+            if (children.size() != 2)
+            {
+                throw std::logic_error("A division function must have no more than 2 children.");
+            }
+
+            const auto& numer = children[0];
+            const auto& denom = children[1];
+            auto result = Util::Interval::Empty(denom.MaybeNaN);
+            if (denom.Lower < Threshold && denom.Upper > -Threshold)
+            {
+                result = Util::Hull(result, Util::Interval::Point(1.0)); // the protected case
+            }
+            if (denom.Lower <= -Threshold)
+            {
+                result = Util::Hull(result, numer / Util::Interval{ denom.Lower, std::min(denom.Upper, -Threshold) });
+            }
+            if (denom.Upper >= Threshold)
+            {
+                result = Util::Hull(result, numer / Util::Interval{ std::max(denom.Lower, Threshold), denom.Upper });
+            }
+            return result;
+        };
+        auto dual = [](const ChildDuals& children) -> Util::Dual
+        {
+            if (children.size() == 1)
+            {
+                return children[0];
+            }
+            if (children.size() != 2)
+            {
+                throw std::logic_error("A division function must have no more than 2 children.");
+            }
+            if (std::abs(children[1].Value) < Threshold)
+            {
+                return Util::Dual::Constant(1.0); // the protected case
+            }
+            return children[0] / children[1];
+        };
+        return std::make_unique<Function>(FunctionType::Division, func, bound, dual, "/", 2, 2);
     }
 
     std::unique_ptr<INode> FunctionFactory::CreateSquareRoot()
@@ -204,7 +323,15 @@ namespace Model
             // returns sqrt(|x|) to prevent NaN
             return std::sqrt(std::abs(children[0]->Evaluate()));
         };
-        return std::make_unique<Function>(func, "√", 1, 1);
+        auto bound = [](const ChildIntervals& children) -> Util::Interval
+        {
+            return Util::Increasing(Util::Abs(children.at(0)), [](double x) { return std::sqrt(x); });
+        };
+        auto dual = [](const ChildDuals& children) -> Util::Dual
+        {
+            return Util::Sqrt(Util::Abs(children.at(0)));
+        };
+        return std::make_unique<Function>(FunctionType::SquareRoot, func, bound, dual, "√", 1, 1);
     }
 
     std::unique_ptr<INode> FunctionFactory::CreateSine()
@@ -217,7 +344,15 @@ namespace Model
             }
             return std::sin(children[0]->Evaluate());
         };
-        return std::make_unique<Function>(func, "sin", 1, 1);
+        auto bound = [](const ChildIntervals& children) -> Util::Interval
+        {
+            return Util::Sine(children.at(0));
+        };
+        auto dual = [](const ChildDuals& children) -> Util::Dual
+        {
+            return Util::Sin(children.at(0));
+        };
+        return std::make_unique<Function>(FunctionType::Sine, func, bound, dual, "sin", 1, 1);
     }
 
     std::unique_ptr<INode> FunctionFactory::CreateCosine()
@@ -230,7 +365,15 @@ namespace Model
             }
             return std::cos(children[0]->Evaluate());
         };
-        return std::make_unique<Function>(func, "cos", 1, 1);
+        auto bound = [](const ChildIntervals& children) -> Util::Interval
+        {
+            return Util::Cosine(children.at(0));
+        };
+        auto dual = [](const ChildDuals& children) -> Util::Dual
+        {
+            return Util::Cos(children.at(0));
+        };
+        return std::make_unique<Function>(FunctionType::Cosine, func, bound, dual, "cos", 1, 1);
     }
 
     std::unique_ptr<INode> FunctionFactory::CreateExponential()
@@ -243,7 +386,15 @@ namespace Model
             }
             return std::exp(children[0]->Evaluate());
         };
-        return std::make_unique<Function>(func, "e^", 1, 1);
+        auto bound = [](const ChildIntervals& children) -> Util::Interval
+        {
+            return Util::Increasing(children.at(0), [](double x) { return std::exp(x); });
+        };
+        auto dual = [](const ChildDuals& children) -> Util::Dual
+        {
+            return Util::Exp(children.at(0));
+        };
+        return std::make_unique<Function>(FunctionType::NaturalExponential, func, bound, dual, "e^", 1, 1);
     }
 
     std::unique_ptr<INode> FunctionFactory::CreateLog()
@@ -262,6 +413,30 @@ namespace Model
             }
             return std::log(child);
         };
-        return std::make_unique<Function>(func, "ln", 1, 1);
+        auto bound = [](const ChildIntervals& children) -> Util::Interval
+        {
+            auto child = Util::Abs(children.at(0));
+            auto result = Util::Interval::Empty(child.MaybeNaN);
+            if (child.Lower < Threshold)
+            {
+                result = Util::Hull(result, Util::Interval::Point(0.0)); // the protected case
+            }
+            if (child.Upper >= Threshold)
+            {
+                Util::Interval clamped{ std::max(child.Lower, Threshold), child.Upper, child.MaybeNaN };
+                result = Util::Hull(result, Util::Increasing(clamped, [](double x) { return std::log(x); }));
+            }
+            return result;
+        };
+        auto dual = [](const ChildDuals& children) -> Util::Dual
+        {
+            auto child = Util::Abs(children.at(0));
+            if (child.Value < Threshold)
+            {
+                return Util::Dual::Constant(0.0); // the protected case
+            }
+            return Util::Log(child);
+        };
+        return std::make_unique<Function>(FunctionType::NaturalLogarithm, func, bound, dual, "ln", 1, 1);
     }
 }
@@ -3,6 +3,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "INode.h"
 
 namespace Model
@@ -37,10 +38,25 @@ namespace Model
 
         /**
          * Create a variable
-         * @param varaible A pointer to the variable
+         * @param varaible A pointer to the variable, or nullptr for an ephemeral random constant
+         * @param symbol The symbolic representation of the variable. Unused for a constant.
          * @return the new INode
          */
-        static std::unique_ptr<INode> Create(const double* variable);
+        static std::unique_ptr<INode> Create(const double* variable, std::string symbol);
+
+        /**
+         * Create one of a set of variables, named for its index
+         * @param variables Pointers to the variables, where nullptr is an ephemeral random constant
+         * @param index The index of the variable to create
+         * @return the new INode
+         */
+        static std::unique_ptr<INode> Create(const std::vector<double*>& variables, int index);
+
+        /**
+         * @param index The index of a variable, ie its column in the fitness cases
+         * @return the symbolic representation of the variable: a to z, then a1 to z1, and so on
+         */
+        static std::string VariableSymbol(int index);
 
         /**
          * @param type The enum represtionation of a function type
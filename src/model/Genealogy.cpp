@@ -0,0 +1,329 @@
+#include "Genealogy.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include "Chromosome.h"
+#include "Constant.h"
+#include "FunctionFactory.h"
+
+namespace
+{
+    const int RandomTreeSize = 4; // the target size of the random S-expressions that operators combine parents with
+
+    /**
+     * @return a function of two children
+     */
+    std::unique_ptr<Model::INode> Combine(Model::FunctionType type, std::unique_ptr<Model::INode> left, std::unique_ptr<Model::INode> right)
+    {
+        auto function = Model::FunctionFactory::Create(type);
+        function->AddChild(std::move(left));
+        function->AddChild(std::move(right));
+        return function;
+    }
+
+    /**
+     * @return (/ 1 (+ 1 (e^ (- 0 tree)))), the sigmoid of tree
+     */
+    std::unique_ptr<Model::INode> Sigmoid(std::unique_ptr<Model::INode> tree)
+    {
+        using Model::FunctionType;
+        auto exp = Model::FunctionFactory::Create(FunctionType::NaturalExponential);
+        exp->AddChild(Combine(FunctionType::Subtraction, std::make_unique<Model::Constant>(0.0), std::move(tree)));
+        return Combine(FunctionType::Division, std::make_unique<Model::Constant>(1.0),
+                Combine(FunctionType::Addition, std::make_unique<Model::Constant>(1.0), std::move(exp)));
+    }
+}
+
+namespace Model
+{
+    Genealogy::Genealogy(const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& terminalSet,
+            const std::vector<double>& fitnessCases, const std::vector<double>& terminals, double mutationStep)
+        : m_allowedFunctions(allowedFunctions)
+        , m_terminalSet(terminalSet)
+        , m_fitnessCases(fitnessCases)
+        , m_terminals(terminals)
+        , m_mutationStep(mutationStep)
+    {
+    }
+
+    int Genealogy::AddTree(std::unique_ptr<INode> tree, std::vector<double>& semantics, std::vector<double>& terminals)
+    {
+        Entry entry;
+        entry.Kind = Origin::Tree;
+        entry.Size = tree->Size();
+        semantics = EvaluateRows(*tree, m_fitnessCases, terminals);
+        entry.Trees[0] = std::move(tree);
+        return Add(entry);
+    }
+
+    std::tuple<int, int> Genealogy::AddCrossover(int left, int right, std::vector<double>& leftSemantics,
+            std::vector<double>& rightSemantics, std::vector<double>& terminals)
+    {
+        std::vector<double> sigmoid;
+        auto tree = CreateSigmoid(sigmoid, terminals);
+        for (auto i = 0u; i < sigmoid.size(); ++i)
+        {
+            auto l = leftSemantics[i];
+            auto r = rightSemantics[i];
+            leftSemantics[i] = l * sigmoid[i] + r * (1.0 - sigmoid[i]);
+            rightSemantics[i] = r * sigmoid[i] + l * (1.0 - sigmoid[i]);
+        }
+
+        // (+ (* A S) (* B (- 1 S)))
+        Entry leftEntry, rightEntry;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            leftEntry.Size = rightEntry.Size = std::min<long>(m_entries.at(left).Size + m_entries.at(right).Size
+                    + 2L*tree->Size() + 5, std::numeric_limits<int>::max());
+        }
+        leftEntry.Kind = rightEntry.Kind = Origin::Crossover;
+        leftEntry.Trees[0] = rightEntry.Trees[0] = tree;
+        leftEntry.Parents[0] = rightEntry.Parents[1] = left;
+        leftEntry.Parents[1] = rightEntry.Parents[0] = right;
+        return { Add(leftEntry), Add(rightEntry) };
+    }
+
+    int Genealogy::AddMutation(int parent, std::vector<double>& semantics, std::vector<double>& terminals)
+    {
+        std::vector<double> first, second;
+        Entry entry;
+        entry.Kind = Origin::Mutation;
+        entry.Parents[0] = parent;
+        entry.Trees[0] = CreateSigmoid(first, terminals);
+        entry.Trees[1] = CreateSigmoid(second, terminals);
+        for (auto i = 0u; i < semantics.size(); ++i)
+        {
+            semantics[i] = semantics[i] + m_mutationStep * (first[i] - second[i]);
+        }
+
+        // (+ A (* step (- S1 S2)))
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            entry.Size = std::min<long>(m_entries.at(parent).Size + entry.Trees[0]->Size() + entry.Trees[1]->Size() + 4,
+                    std::numeric_limits<int>::max());
+        }
+        return Add(entry);
+    }
+
+    std::size_t Genealogy::Terminals() const
+    {
+        return m_terminals.size();
+    }
+
+    void Genealogy::Retain(int id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_entries.at(id).References;
+    }
+
+    void Genealogy::Release(int id)
+    {
+        // iteratively, since a chain of ancestors that nothing else refers to may be as long as the run
+        std::vector<int> released { id };
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (!released.empty())
+        {
+            auto it = m_entries.find(released.back());
+            released.pop_back();
+            if (--it->second.References > 0)
+            {
+                continue;
+            }
+
+            for (auto parent : it->second.Parents)
+            {
+                if (parent >= 0)
+                {
+                    released.push_back(parent);
+                }
+            }
+            m_entries.erase(it);
+        }
+    }
+
+    int Genealogy::Entries() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return static_cast<int>(m_entries.size());
+    }
+
+    int Genealogy::Size(int id) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return static_cast<int>(m_entries.at(id).Size);
+    }
+
+    std::unique_ptr<INode> Genealogy::Reconstruct(int id) const
+    {
+        auto ancestors = Ancestors(id);
+
+        // how many times each ancestor is a parent, so that its last use can take its S-expression, not clone it
+        std::unordered_map<int, int> uses;
+        for (const auto& [ancestor, entry] : ancestors)
+        {
+            for (auto parent : entry.Parents)
+            {
+                if (parent >= 0)
+                {
+                    ++uses[parent];
+                }
+            }
+        }
+        std::unordered_map<int, std::unique_ptr<INode>> built;
+        auto take = [&](int parent)
+        {
+            auto& tree = built[parent];
+            return --uses[parent] > 0 ? tree->Clone() : std::move(tree);
+        };
+
+        for (const auto& [ancestor, entry] : ancestors)
+        {
+            switch (entry.Kind)
+            {
+            case Origin::Crossover:
+            {
+                auto left = take(entry.Parents[0]);
+                auto right = take(entry.Parents[1]);
+                auto oneLess = Combine(FunctionType::Subtraction, std::make_unique<Constant>(1.0), entry.Trees[0]->Clone());
+                built[ancestor] = Combine(FunctionType::Addition,
+                        Combine(FunctionType::Multiplication, std::move(left), entry.Trees[0]->Clone()),
+                        Combine(FunctionType::Multiplication, std::move(right), std::move(oneLess)));
+                break;
+            }
+            case Origin::Mutation:
+            {
+                auto difference = Combine(FunctionType::Subtraction, entry.Trees[0]->Clone(), entry.Trees[1]->Clone());
+                built[ancestor] = Combine(FunctionType::Addition, take(entry.Parents[0]),
+                        Combine(FunctionType::Multiplication, std::make_unique<Constant>(m_mutationStep), std::move(difference)));
+                break;
+            }
+            case Origin::Tree:
+            default:
+                built[ancestor] = entry.Trees[0]->Clone();
+                break;
+            }
+        }
+        return std::move(built[id]);
+    }
+
+    std::vector<double> Genealogy::Evaluate(int id, const std::vector<double>& cases, std::vector<double>& terminals) const
+    {
+        // so each ancestor is evaluated once, from the oldest, in the same way as its semantics were calculated
+        std::unordered_map<int, std::vector<double>> outputs;
+        auto evaluateTree = [&](const INode& tree)
+        {
+            // the S-expressions are shared, so copies are pointed to the terminals
+            auto copy = tree.Clone();
+            return EvaluateRows(*copy, cases, terminals);
+        };
+        for (const auto& [ancestor, entry] : Ancestors(id))
+        {
+            auto& output = outputs[ancestor];
+            switch (entry.Kind)
+            {
+            case Origin::Crossover:
+            {
+                auto sigmoid = evaluateTree(*entry.Trees[0]);
+                const auto& left = outputs[entry.Parents[0]];
+                const auto& right = outputs[entry.Parents[1]];
+                output.resize(sigmoid.size());
+                for (auto row = 0u; row < sigmoid.size(); ++row)
+                {
+                    output[row] = left[row] * sigmoid[row] + right[row] * (1.0 - sigmoid[row]);
+                }
+                break;
+            }
+            case Origin::Mutation:
+            {
+                auto first = evaluateTree(*entry.Trees[0]);
+                auto second = evaluateTree(*entry.Trees[1]);
+                output = outputs[entry.Parents[0]];
+                for (auto row = 0u; row < first.size(); ++row)
+                {
+                    output[row] = output[row] + m_mutationStep * (first[row] - second[row]);
+                }
+                break;
+            }
+            case Origin::Tree:
+            default:
+                output = evaluateTree(*entry.Trees[0]);
+                break;
+            }
+        }
+        return outputs[id];
+    }
+
+    int Genealogy::Add(const Entry& entry)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto parent : entry.Parents)
+        {
+            if (parent >= 0)
+            {
+                ++m_entries.at(parent).References;
+            }
+        }
+        m_entries.emplace(m_nextId, entry);
+        return m_nextId++;
+    }
+
+    std::vector<std::pair<int, Genealogy::Entry>> Genealogy::Ancestors(int id) const
+    {
+        std::vector<std::pair<int, Entry>> ancestors;
+        std::vector<int> pending { id };
+        std::unordered_map<int, bool> visited;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (!pending.empty())
+            {
+                auto ancestor = pending.back();
+                pending.pop_back();
+                if (visited[ancestor])
+                {
+                    continue;
+                }
+
+                visited[ancestor] = true;
+                const auto& entry = m_entries.at(ancestor);
+                ancestors.emplace_back(ancestor, entry);
+                for (auto parent : entry.Parents)
+                {
+                    if (parent >= 0)
+                    {
+                        pending.push_back(parent);
+                    }
+                }
+            }
+        }
+
+        // parents always have lower IDs than their offspring
+        std::sort(ancestors.begin(), ancestors.end(),
+                [](const auto& a, const auto& b) { return a.first < b.first; });
+        return ancestors;
+    }
+
+    std::shared_ptr<const INode> Genealogy::CreateSigmoid(std::vector<double>& semantics, std::vector<double>& terminals)
+    {
+        auto tree = Sigmoid(Chromosome::CreateRandomChromosome(RandomTreeSize, m_allowedFunctions, m_terminalSet));
+        semantics = EvaluateRows(*tree, m_fitnessCases, terminals);
+        return tree;
+    }
+
+    std::vector<double> Genealogy::EvaluateRows(INode& tree, const std::vector<double>& cases, std::vector<double>& terminals) const
+    {
+        int columns = static_cast<int>(m_terminals.size()) + 1; // incl dependent variable
+        int totalCases = cases.size() / columns;
+
+        tree.Rebind(m_terminals.data(), terminals.data(), m_terminals.size());
+        std::vector<double> outputs(totalCases);
+        for (int i = 0; i < totalCases; ++i)
+        {
+            auto begin = cases.begin() + i*columns;
+            std::copy(begin, begin + columns - 1, terminals.begin());
+            outputs[i] = tree.Evaluate();
+        }
+        tree.Rebind(terminals.data(), m_terminals.data(), m_terminals.size());
+        return outputs;
+    }
+}
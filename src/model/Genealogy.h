@@ -0,0 +1,186 @@
+#ifndef Genealogy_H
+#define Genealogy_H
+
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "INode.h"
+
+namespace Model
+{
+    enum class FunctionType;
+
+    /**
+     * Records how each individual of a geometric semantic population was made, so that the offspring of the
+     * geometric semantic operators needn't hold (or evaluate) their exponentially growing S-expressions.
+     *
+     * Each individual is identified by the ID of its entry. An entry is either an initial, random S-expression,
+     * or references the entries of its parents plus one or two random S-expressions:
+     * - crossover of parents A and B is A*S + B*(1 - S),
+     * - mutation of parent A is A + step*(S1 - S2),
+     * where each S = 1/(1 + e^-R) is the sigmoid of a new, random S-expression R.
+     *
+     * Semantics (the output of an individual for each fitness case) are computed from those of the parents in
+     * time linear in the number of fitness cases, independent of the size of the parents. The S-expression of an
+     * individual is only reconstructed upon request.
+     *
+     * Entries are reference counted by the living individuals and by their offspring's entries, so those that no
+     * living individual descends from are removed, along with their random S-expressions.
+     */
+    class Genealogy
+    {
+    public:
+        /**
+         * Constructor
+         * @param allowedFunctions The functions that random S-expressions are built from
+         * @param terminalSet The variables that random S-expressions are built from, and nullptr to denote
+         *        an ephemeral random constant
+         * @param fitnessCases The training data, in rows of the variables followed by the expected value
+         * @param terminals The variables pointed to by the S-expressions
+         * @param mutationStep The step by which mutation perturbs the semantics of its parent
+         */
+        Genealogy(const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& terminalSet,
+                const std::vector<double>& fitnessCases, const std::vector<double>& terminals, double mutationStep);
+
+        /**
+         * Adds an initial individual. May be called from several threads at once, provided each has its own terminals,
+         * as may AddCrossover and AddMutation.
+         * @param tree The S-expression of the individual
+         * @param semantics Set to the output of the individual for each fitness case
+         * @param terminals The buffer to evaluate with, the same size as the genealogy's terminals
+         * @return the ID of the individual
+         */
+        int AddTree(std::unique_ptr<INode> tree, std::vector<double>& semantics, std::vector<double>& terminals);
+
+        /**
+         * Adds the two offspring of geometric semantic crossover. The second offspring swaps the roles of the parents.
+         * @param left The ID of the first parent
+         * @param right The ID of the second parent
+         * @param leftSemantics The semantics of the first parent, updated to those of the first offspring
+         * @param rightSemantics The semantics of the second parent, updated to those of the second offspring
+         * @param terminals The buffer to evaluate with, the same size as the genealogy's terminals
+         * @return the IDs of the offspring
+         */
+        std::tuple<int, int> AddCrossover(int left, int right, std::vector<double>& leftSemantics,
+                std::vector<double>& rightSemantics, std::vector<double>& terminals);
+
+        /**
+         * Adds the offspring of geometric semantic mutation
+         * @param parent The ID of the parent
+         * @param semantics The semantics of the parent, updated to those of the offspring
+         * @param terminals The buffer to evaluate with, the same size as the genealogy's terminals
+         * @return the ID of the offspring
+         */
+        int AddMutation(int parent, std::vector<double>& semantics, std::vector<double>& terminals);
+
+        /**
+         * @return the number of terminals, which a buffer to evaluate with must hold
+         */
+        std::size_t Terminals() const;
+
+        /**
+         * Counts a reference to an entry, such as by an individual that has its ID
+         */
+        void Retain(int id);
+
+        /**
+         * Removes a reference to an entry. Once nothing refers to it, it's removed, then so is any of its
+         * ancestors that nothing else refers to.
+         */
+        void Release(int id);
+
+        /**
+         * @return the number of entries, ie the living individuals and their ancestors
+         */
+        int Entries() const;
+
+        /**
+         * @return the number of nodes in the S-expression of an individual, or the maximum int if it has more
+         */
+        int Size(int id) const;
+
+        /**
+         * Rebuilds the S-expression of an individual from its oldest ancestors up, building each ancestor once
+         * however many times it appears. The S-expression itself can't share subtrees, so this takes time and
+         * memory in proportion to Size.
+         * @return the S-expression of an individual
+         */
+        std::unique_ptr<INode> Reconstruct(int id) const;
+
+        /**
+         * Evaluates an individual for each case, without reconstructing its S-expression. Each ancestor is
+         * evaluated once, however many times it appears in the S-expression.
+         * @param id The individual
+         * @param cases Rows of the variables, each followed by a dependent value (which is ignored)
+         * @param terminals The buffer to evaluate with, the same size as the genealogy's terminals
+         * @return the output of the individual for each case
+         */
+        std::vector<double> Evaluate(int id, const std::vector<double>& cases, std::vector<double>& terminals) const;
+
+    private:
+        /**
+         * How an individual was made
+         */
+        enum class Origin
+        {
+            Tree,      ///< an initial, random S-expression, which is Trees[0]
+            Crossover, ///< Parents[0]*Trees[0] + Parents[1]*(1 - Trees[0])
+            Mutation   ///< Parents[0] + step*(Trees[0] - Trees[1])
+        };
+
+        /**
+         * An individual, by reference to its parents and the S-expressions that combine them
+         */
+        struct Entry
+        {
+            Origin Kind = Origin::Tree;
+            int Parents[2] = { -1, -1 }; ///< IDs of the parents, or -1 if none
+            std::shared_ptr<const INode> Trees[2]; ///< The S-expressions, which both offspring of a crossover share
+            long Size = 0; ///< The size of the S-expression of the individual, at most the maximum int
+            int References = 0; ///< The number of individuals and offspring entries that refer to the entry
+        };
+
+        /**
+         * Adds an entry, which refers to its parents
+         * @return its ID
+         */
+        int Add(const Entry& entry);
+
+        /**
+         * @return an individual and its ancestors by ID, oldest first
+         */
+        std::vector<std::pair<int, Entry>> Ancestors(int id) const;
+
+        /**
+         * Creates a new, random S-expression wrapped in a sigmoid, and evaluates it
+         * @param semantics Set to the output of the S-expression for each fitness case
+         * @param terminals The buffer to evaluate with
+         * @return the S-expression
+         */
+        std::shared_ptr<const INode> CreateSigmoid(std::vector<double>& semantics, std::vector<double>& terminals);
+
+        /**
+         * Evaluates an S-expression with the given terminals, then points it back to the genealogy's
+         * @param tree The S-expression, which points to the genealogy's terminals and no other thread uses
+         * @param cases Rows of the variables, each followed by a dependent value (which is ignored)
+         * @param terminals The buffer to evaluate with, which no other thread uses
+         * @return the output of the S-expression for each case
+         */
+        std::vector<double> EvaluateRows(INode& tree, const std::vector<double>& cases, std::vector<double>& terminals) const;
+
+        const std::vector<FunctionType> m_allowedFunctions; ///< The functions of random S-expressions
+        const std::vector<double*> m_terminalSet; ///< The variables of random S-expressions
+        const std::vector<double>& m_fitnessCases; ///< The training data
+        const std::vector<double>& m_terminals; ///< The variables pointed to by the S-expressions it holds
+        const double m_mutationStep; ///< The step by which mutation perturbs semantics
+
+        std::unordered_map<int, Entry> m_entries; ///< Each individual, and each of its ancestors, by ID
+        int m_nextId = 0; ///< The ID of the next entry, so offspring always have greater IDs than their parents
+        mutable std::mutex m_mutex; ///< Guards m_entries and m_nextId, which several threads may use
+    };
+}
+
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+namespace Model
+{
+    /**
+     * The genetic operators that modify offspring
+     */
+    enum class GeneticOperator
+    {
+        Crossover = 0,
+        Mutation,
+        HoistMutation
+    };
+
+    const int NumberOfGeneticOperators = 3; ///< The number of GeneticOperators
+}
@@ -1,13 +1,18 @@
 #ifndef IChromosome_H
 #define IChromosome_H
 
+#include <limits>
 #include <vector>
+#include "GeneticOperator.h"
 #include "INode.h"
+#include "TreeLimits.h"
 #include "../utils/UniformRandomGenerator.h"
 
 namespace Model
 {
     enum class FunctionType;
+    class MutationTable;
+    class RowPartition;
 
     /**
      * Represents an individual chromosome (S-expression) in the population,
@@ -24,33 +29,73 @@ namespace Model
 
         /**
          * Less-than operator. Used for sorting collections of Chromosomes.
+         * Compares the weighted fitness directly, so sorting needs neither virtual calls nor casts.
          */
-        virtual bool operator<(const IChromosome& rhs) const = 0;
+        bool operator<(const IChromosome& rhs) const { return m_weightedFitness < rhs.m_weightedFitness; }
 
         /**
          * @return the size/length of the Chromosome
          */
-        virtual int Size() const = 0;
+        int Size() const { return m_size; }
+
+        /**
+         * @return the estimated cost of evaluating the Chromosome, which the parsimony coefficient penalises.
+         * This is its size, unless it was costed by a CostTable.
+         */
+        double Cost() const { return m_cost; }
 
         /**
          * @return the fitness of the Chromosome
          */
-        virtual double Fitness() const = 0;
+        double Fitness() const { return m_fitness; }
 
         /**
-         * @return a clone of the current Chromosome
+         * @return the fitness of the Chromosome, with a penalty for its size
+         */
+        double WeightedFitness() const { return m_weightedFitness; }
+
+        /**
+         * Recalculates the weighted fitness for a new parsimony coefficient, without re-evaluating the fitness
+         * @param parsimonyCoefficient The coefficient used to penalise long chromosomes
+         */
+        void Reweigh(double parsimonyCoefficient) { m_weightedFitness = CalculateWeightedFitness(parsimonyCoefficient); }
+
+        /**
+         * Sets the estimated cost of evaluating the Chromosome, and recalculates the weighted fitness
+         * @param cost The cost of the S-expression, such as by INode::Cost
+         * @param parsimonyCoefficient The coefficient used to penalise costly chromosomes
+         */
+        void SetCost(double cost, double parsimonyCoefficient)
+        {
+            m_cost = cost;
+            Reweigh(parsimonyCoefficient);
+        }
+
+        /**
+         * @return a clone of the current Chromosome. The clone is not considered modified.
          */
         virtual std::unique_ptr<IChromosome> Clone() const = 0;
 
+        /**
+         * @return true if an operator has modified the Chromosome since it was created or cloned, 
+         * in which case its fitness is out of date.
+         */
+        bool IsModified() const { return m_operators != 0; }
+
+        /**
+         * @return true if the operator has modified the Chromosome since it was created or cloned
+         */
+        bool IsModifiedBy(GeneticOperator op) const { return (m_operators & Bit(op)) != 0; }
+
         /**
          * Performs standard mutation on a chromosome. 
          * 
          * A gene is randomly selected, and mutated to another valid, random gene from the set of allowed 
-         * functions and terminals.
-         * @param allowedFunctions The allowed set of functions that may be selected from
-         * @param variables The allowed set of terminals that may be selected from
+         * functions and terminals. The shape of the S-expression is unchanged, so mutation can't
+         * exceed any TreeLimits that the chromosome is already within.
+         * @param mutations The allowed sets of functions and terminals that may be selected from
          */
-        virtual void Mutate(const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables) = 0;
+        virtual void Mutate(const MutationTable& mutations) = 0;
 
         /**
          * Performs hoist mutation on a chromosome. 
@@ -63,11 +108,14 @@ namespace Model
         virtual void HoistMutate() = 0;
 
         /**
-         * Performs crossover on a pair of chromosomes
-         * @param left The first S-expression/chromosome
+         * Performs crossover on a pair of chromosomes.
+         *
+         * Crossover points that would take either offspring beyond the limits are re-picked up to
+         * limits.Retries times, after which the crossover is rejected and neither chromosome changes.
          * @param right The second S-expression/chromosome
+         * @param limits The limits on the depth and size of the offspring
          */
-        virtual void Crossover(IChromosome& right) = 0;
+        virtual void Crossover(IChromosome& right, const TreeLimits& limits) = 0;
 
         /**
          * @return a reference to the tree representation of the Chromosome
@@ -80,6 +128,11 @@ namespace Model
          */
         virtual std::string ToString() const = 0;
 
+        /**
+         * @return a description of the Chromosome that's cheap enough to log each generation
+         */
+        virtual std::string Summary() const { return ToString(); }
+
         /**
          * Allows for prediction of new values.
          * @param fitnessCases The original training data.
@@ -95,27 +148,44 @@ namespace Model
          * @param terminals A reference to the Terminals pointed to by each Chromosome (for evaluation).
          * @param cutoff Used for TimeSeries data to specify where known values end. For example, cutoff=128
          * indicates there are 128 know values, and we want to predict (predictionCases-cutoff) steps ahead.
+         * @param rows If set, the prediction cases may be split across its threads
          */
-        virtual void Predict(std::vector<double>& predictionCases, std::vector<double>& terminals, int cutoff = 0) const {}
+        virtual void Predict(std::vector<double>& predictionCases, std::vector<double>& terminals, int cutoff = 0,
+                const RowPartition* rows = nullptr) const {}
 
     protected:
         /**
-         * Calculate the fitness for one chromosome.
-         * @param chromosome The chromosome to evaluate
-         * @return the chromosome fitness as a positive, real number
+         * Copy constructor. The copy is not considered modified.
+         */
+        IChromosome(const IChromosome& other)
+            : m_size(other.m_size)
+            , m_cost(other.m_cost)
+            , m_fitness(other.m_fitness)
+            , m_weightedFitness(other.m_weightedFitness)
+        {
+        }
+
+        /**
+         * Calculate the weighted fitness of the chromosome, where longer (or costlier) chromosomes are penalized.
+         * @param parsimonyCoefficient The coefficient that is multiplied by the Chromosome cost.
          */
-        virtual double CalculateFitness(const std::vector<double>& fitnessCases, std::vector<double>& terminals) = 0;
+        double CalculateWeightedFitness(double parsimonyCoefficient) const { return m_fitness + parsimonyCoefficient * m_cost; }
 
         /**
-         * Calculate the weighted fitness of the chromosome, where longer chromosomes are penalized.
-         * @param parsimonyCoefficient The coefficient that is multiplied by the Chromosome size.
+         * Records that an operator has modified the Chromosome, so its fitness is out of date
          */
-        virtual double CalculateWeightedFitness(double parsimonyCoefficient) const = 0;
+        void SetModifiedBy(GeneticOperator op) { m_operators |= Bit(op); }
 
         /**
-         * Set the cached size of the Chromosome
+         * @return the bit that records an operator in m_operators
          */
-        virtual void SetSize() = 0;
+        static unsigned Bit(GeneticOperator op) { return 1u << static_cast<unsigned>(op); }
+
+        int m_size = 0; ///< the length (nodes in the tree)
+        double m_cost = 0.0; ///< the estimated cost of evaluation, which is the size unless set otherwise
+        double m_fitness = std::numeric_limits<double>::max(); ///< raw fitness of the chromosome
+        double m_weightedFitness = std::numeric_limits<double>::max(); ///< weighted fitness, with penalty for length/size
+        unsigned m_operators = 0; ///< The operators that have modified the S-expression since the fitness was calculated
     };
 }
 
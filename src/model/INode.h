@@ -1,12 +1,45 @@
 #ifndef INode_H
 #define INode_H
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
+#include "CostTable.h"
+#include "../utils/Dual.h"
+#include "../utils/Interval.h"
 
 namespace Model
 {
+    /**
+     * The range of values each variable (terminal) takes over the fitness cases
+     */
+    using VariableRanges = std::map<const double*, Util::Interval>;
+
+    class INode;
+
+    /**
+     * The nodes of a tree in prefix order, such that Slots[i] is the unique_ptr returned by Get(i).
+     */
+    struct NodeIndex
+    {
+        std::vector<std::unique_ptr<INode>*> Slots; ///< The unique_ptr that owns each node
+        std::vector<int> Sizes; ///< The size of the subtree rooted at each node
+        std::vector<int> Depths; ///< The depth of each node, where the root is at depth 0
+        std::vector<int> Heights; ///< The height of the subtree rooted at each node, where a leaf has height 0
+
+        /**
+         * Empties the index, such as when the tree has changed
+         */
+        void Clear()
+        {
+            Slots.clear();
+            Sizes.clear();
+            Depths.clear();
+            Heights.clear();
+        }
+    };
+
     /**
      * An interface Node of the genetic programming tree/model.
      */
@@ -25,6 +58,29 @@ namespace Model
          */
         virtual double Evaluate() const = 0;
 
+        /**
+         * Bounds the value of this subtree, given the range of each variable.
+         * @param ranges The range of values each variable may take
+         * @return an interval containing every value Evaluate() could return
+         */
+        virtual Util::Interval EvaluateInterval(const VariableRanges& ranges) const = 0;
+
+        /**
+         * Bounds the value of this subtree, and replaces any descendant function whose value
+         * is provably constant over the variable ranges with a Constant.
+         * @param ranges The range of values each variable may take
+         * @return an interval containing every value Evaluate() could return
+         */
+        virtual Util::Interval FoldConstants(const VariableRanges& ranges) { return EvaluateInterval(ranges); }
+
+        /**
+         * Evaluates the value of this subtree, and its derivatives with respect to the values of any
+         * of its Constants at once (i.e. forward-mode automatic differentiation).
+         * @param seeds The Constants to differentiate with respect to, by index
+         * @return the value and derivatives of this subtree
+         */
+        virtual Util::Dual EvaluateDual(const std::vector<const INode*>& seeds) const = 0;
+
         /**
          * @return the string representation of this subtree.
          */
@@ -68,6 +124,26 @@ namespace Model
          */
         virtual std::unique_ptr<INode> Clone() const = 0;
 
+        /**
+         * @return a hash of this (sub)tree. Trees that are the same have the same hash.
+         */
+        virtual std::size_t Hash() const = 0;
+
+        /**
+         * @return the estimated cost of evaluating this (sub)tree
+         * @param costs The cost of each primitive
+         */
+        virtual double Cost(const CostTable& costs) const { return costs.Leaf(); }
+
+        /**
+         * Points each variable of this (sub)tree that lies in one buffer of terminals to the same variable 
+         * in another buffer, such that threads may each evaluate S-expressions with their own terminals.
+         * @param from The first variable of the buffer currently pointed to
+         * @param to The first variable of the buffer to point to instead
+         * @param count The number of variables in each buffer
+         */
+        virtual void Rebind(const double* from, const double* to, std::size_t count) { }
+
         /**
          * returns true if the number of children is less than the minimum required
          */
@@ -81,6 +157,20 @@ namespace Model
          */
         virtual std::unique_ptr<INode>& Get(int index, std::unique_ptr<INode>& ptr) = 0;
 
+        /**
+         * Appends this subtree to an index of its nodes, in prefix order
+         * @param ptr The unique_ptr that owns this node
+         * @param index The index to append to
+         * @param depth The depth of this node within the tree
+         */
+        virtual void IndexNodes(std::unique_ptr<INode>& ptr, NodeIndex& index, int depth)
+        {
+            index.Slots.push_back(&ptr);
+            index.Sizes.push_back(1);
+            index.Depths.push_back(depth);
+            index.Heights.push_back(0);
+        }
+
         /**
          * Compares two INodes to determine if they are the same (ignoring children)
          * @param other The other INode to compare against
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace Model
+{
+    /**
+     * Methods of creating the random S-expressions of the initial population
+     */
+    enum class InitialisationMethod
+    {
+        Grow = 0, ///< each new node is equally likely to be a function or a terminal
+        Full,     ///< every node is a function until the target size is reached, giving bushy trees
+        Ramped    ///< ramped half-and-half: half grow and half full, with depths ramped from 2 up to that of a 
+                  ///< full binary tree of double the minimum size
+    };
+}
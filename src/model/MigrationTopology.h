@@ -0,0 +1,14 @@
+#pragma once
+
+namespace Model
+{
+    /**
+     * Which islands each island of a population sends its migrants to
+     */
+    enum class MigrationTopology
+    {
+        Ring = 0,      ///< each island sends to the next, and the last to the first
+        Random,        ///< each island sends to another island, drawn anew each migration
+        FullyConnected ///< each island sends to every other island
+    };
+}
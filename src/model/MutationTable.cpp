@@ -0,0 +1,95 @@
+#include "MutationTable.h"
+
+#include <algorithm>
+#include <numeric>
+#include "ChromosomeUtil.h"
+#include "FunctionFactory.h"
+#include "Terminal.h"
+
+namespace Model
+{
+    using namespace ChromosomeUtil;
+
+    MutationTable::MutationTable(const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables)
+        : m_variables(variables)
+    {
+        std::vector<std::pair<int, FunctionType>> arities;
+        for (auto type : allowedFunctions)
+        {
+            arities.emplace_back(FunctionFactory::Create(type)->MaxChildren(), type);
+        }
+        std::stable_sort(arities.begin(), arities.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (auto& [maxChildren, type] : arities)
+        {
+            m_maxChildren.push_back(maxChildren);
+            m_functions.push_back(type);
+        }
+
+        for (auto i = 0u; i < m_variables.size(); ++i)
+        {
+            m_variableIndices.emplace(m_variables[i], i);
+        }
+    }
+
+    void MutationTable::Mutate(std::unique_ptr<INode>& gene) const
+    {
+        if (IsTerminal(gene))
+        {
+            MutateTerminal(gene);
+        }
+        else
+        {
+            MutateFunction(gene);
+        }
+    }
+
+    void MutationTable::MutateFunction(std::unique_ptr<INode>& gene) const
+    {
+        // functions are in descending order of max children, so those that can hold 
+        // all of the gene's children are a prefix of m_functions
+        int children = gene->NumberOfChildren();
+        auto end = std::partition_point(m_maxChildren.begin(), m_maxChildren.end(), 
+                [children](int maxChildren) { return maxChildren >= children; });
+        auto compatible = std::distance(m_maxChildren.begin(), end);
+        if (compatible == 0)
+        {
+            return; // the mutation fails
+        }
+
+        // This does not guarantee that the function will change, since it may be the only compatible type
+        auto newFunction = FunctionFactory::Create(m_functions[RandomIndex(compatible)]);
+        gene->MoveChildrenTo(newFunction); // transfer sub tree
+        gene.swap(newFunction);
+    }
+
+    void MutationTable::MutateTerminal(std::unique_ptr<INode>& gene) const
+    {
+        if (RandInt().GetInRange(0,1) && !m_functions.empty()) // mutate to a function
+        {
+            auto func = FunctionFactory::Create(m_functions[RandomIndex(m_functions.size())]);
+            FillFunction(func.get(), m_variables);
+            gene.swap(func);
+            return;
+        }
+
+        // Prevents mutation to the same variable, by skipping over its index
+        int current = -1;
+        if (auto terminal = dynamic_cast<const Terminal*>(gene.get()))
+        {
+            auto itr = m_variableIndices.find(terminal->GetVariable());
+            current = itr != m_variableIndices.end() ? itr->second : -1;
+        }
+
+        int candidates = static_cast<int>(m_variables.size()) - (current >= 0 ? 1 : 0);
+        if (candidates <= 0)
+        {
+            return; // there is nothing else to mutate to
+        }
+        int index = RandomIndex(candidates);
+        if (current >= 0 && index >= current)
+        {
+            ++index;
+        }
+        gene = FunctionFactory::Create(m_variables, index);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef MutationTable_H
+#define MutationTable_H
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "INode.h"
+
+namespace Model
+{
+    enum class FunctionType;
+
+    /**
+     * The functions and terminals that genes may mutate to. These are arranged upon construction such 
+     * that a valid replacement for any gene is found with a single random draw.
+     */
+    class MutationTable
+    {
+    public:
+        /**
+         * Constructor
+         */
+        MutationTable() = default;
+
+        /**
+         * Constructor
+         * @param allowedFunctions The allowed set of functions that may be mutated to
+         * @param variables The allowed set of terminals that may be mutated to. nullptr denotes an 
+         *        ephemeral random constant.
+         */
+        MutationTable(const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables);
+
+        /**
+         * Replaces a gene with a random one. Functions mutate to a function that can hold all of their
+         * children, and terminals mutate to either a different terminal or a new function (filled with 
+         * terminals). The gene is left as is if there is no valid replacement.
+         * @param gene The gene to mutate
+         */
+        void Mutate(std::unique_ptr<INode>& gene) const;
+
+    private:
+        /**
+         * Replaces a function with a random function that can hold all of its children
+         */
+        void MutateFunction(std::unique_ptr<INode>& gene) const;
+
+        /**
+         * Replaces a terminal with a random, different terminal, or a new function
+         */
+        void MutateTerminal(std::unique_ptr<INode>& gene) const;
+
+        std::vector<FunctionType> m_functions; ///< The allowed functions, in descending order of max children
+        std::vector<int> m_maxChildren; ///< The max children of each of m_functions
+        std::vector<double*> m_variables; ///< The allowed terminals
+        std::map<const double*, int> m_variableIndices; ///< The index of each variable in m_variables
+    };
+}
+#endif
@@ -0,0 +1,91 @@
+#ifndef RowPartition_H
+#define RowPartition_H
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "INode.h"
+#include "../utils/ThreadPool.h"
+
+namespace Model
+{
+    /**
+     * Splits the fitness cases into fixed chunks of rows, and evaluates the chunks of a single S-expression
+     * across a pool of threads. Each thread evaluates its own copy of the S-expression, pointed to its own
+     * terminals.
+     *
+     * The chunks don't depend on the number of threads, and results are returned by chunk, so reducing them
+     * in order gives the same result however many threads there are.
+     */
+    class RowPartition
+    {
+    public:
+        static const int ChunkRows = 1024; ///< The number of rows in each chunk (but the last)
+
+        /**
+         * Constructor
+         * @param pool The threads to split rows across, which mustn't be running another job at the same time
+         * @param terminals The terminals that S-expressions point to
+         */
+        RowPartition(Util::ThreadPool& pool, const std::vector<double>& terminals)
+            : m_pool(pool)
+            , m_terminals(terminals)
+            , m_workerTerminals(pool.Size(), std::vector<double>(terminals.size()))
+        {
+        }
+
+        /**
+         * @return the number of threads that rows are split across
+         */
+        int Threads() const { return m_pool.Size(); }
+
+        /**
+         * @return the number of columns of the fitness cases, incl the dependent variable
+         */
+        int Columns() const { return static_cast<int>(m_terminals.size()) + 1; }
+
+        /**
+         * Evaluates each chunk of rows
+         * @param tree The S-expression, which points to the terminals given at construction
+         * @param rows The number of rows
+         * @param evaluate Called as evaluate(tree, terminals, begin, end) for the rows [begin, end) of each
+         *        chunk, with a copy of the S-expression that points to the given terminals. Returns a Result.
+         * @param cancel If set (by evaluate) while the chunks are evaluated, the remaining chunks are skipped
+         *        and left as default Results
+         * @return the result of each chunk, in order of rows
+         */
+        template <typename Result, typename EvaluateChunk>
+        std::vector<Result> Map(const INode& tree, int rows, EvaluateChunk evaluate,
+                const std::atomic<bool>* cancel = nullptr) const
+        {
+            int chunks = (rows + ChunkRows - 1) / ChunkRows;
+            std::vector<Result> results(chunks);
+            m_pool.Run([&](int worker)
+            {
+                auto& terminals = m_workerTerminals[worker];
+                auto copy = tree.Clone();
+                copy->Rebind(m_terminals.data(), terminals.data(), m_terminals.size());
+
+                // chunks take about as long as each other, so are simply interleaved
+                for (int chunk = worker; chunk < chunks; chunk += m_pool.Size())
+                {
+                    if (cancel && cancel->load(std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                    int begin = chunk * ChunkRows;
+                    results[chunk] = evaluate(static_cast<const INode&>(*copy), terminals, begin,
+                            std::min(rows, begin + ChunkRows));
+                }
+            });
+            return results;
+        }
+
+    private:
+        Util::ThreadPool& m_pool; ///< The threads to split rows across
+        const std::vector<double>& m_terminals; ///< The terminals that S-expressions point to
+        mutable std::vector<std::vector<double>> m_workerTerminals; ///< The terminals of each thread, by index
+    };
+}
+
+#endif
@@ -0,0 +1,142 @@
+#include "SemanticChromosome.h"
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+    const int MaxPrintedSize = 1 << 20; // the largest S-expression that's reconstructed to be printed
+}
+
+namespace Model
+{
+    SemanticChromosome::SemanticChromosome(std::shared_ptr<Genealogy> genealogy, IChromosome::INodePtr tree,
+            std::vector<double>& terminals)
+        : m_genealogy(std::move(genealogy))
+    {
+        SetId(m_genealogy->AddTree(std::move(tree), m_semantics, terminals));
+    }
+
+    SemanticChromosome::SemanticChromosome(const SemanticChromosome& other)
+        : IChromosome(other)
+        , m_genealogy(other.m_genealogy)
+        , m_id(other.m_id)
+        , m_semantics(other.m_semantics)
+    {
+        m_genealogy->Retain(m_id);
+    }
+
+    SemanticChromosome::~SemanticChromosome()
+    {
+        m_genealogy->Release(m_id);
+    }
+
+    void SemanticChromosome::Evaluate(const std::vector<double>& fitnessCases, double parsimonyCoefficient)
+    {
+        if (m_semantics.empty())
+        {
+            return;
+        }
+
+        int columns = fitnessCases.size() / m_semantics.size(); // incl dependent variable
+        double sumOfErrors = 0.0;
+        for (auto i = 0u; i < m_semantics.size(); ++i)
+        {
+            sumOfErrors += std::abs(m_semantics[i] - fitnessCases[(i + 1)*columns - 1]);
+        }
+
+        auto meanAbsoluteError = sumOfErrors / m_semantics.size();
+        m_fitness = std::isfinite(meanAbsoluteError) ? meanAbsoluteError : std::numeric_limits<double>::max();
+        m_weightedFitness = CalculateWeightedFitness(parsimonyCoefficient);
+        m_operators = 0; // the fitness is up to date
+    }
+
+    std::unique_ptr<IChromosome> SemanticChromosome::Clone() const
+    {
+        return std::make_unique<SemanticChromosome>(*this);
+    }
+
+    void SemanticChromosome::Mutate(const MutationTable& mutations)
+    {
+        // operators aren't given the terminals of the thread they run on, so evaluate with a buffer of their own
+        std::vector<double> terminals(m_genealogy->Terminals());
+        SetId(m_genealogy->AddMutation(m_id, m_semantics, terminals));
+        SetModifiedBy(GeneticOperator::Mutation);
+    }
+
+    void SemanticChromosome::HoistMutate()
+    {
+    }
+
+    void SemanticChromosome::Crossover(IChromosome& right, const TreeLimits& limits)
+    {
+        // a population only ever holds one type of Chromosome
+        auto& rhs = static_cast<SemanticChromosome&>(right);
+        std::vector<double> terminals(m_genealogy->Terminals());
+        auto [leftId, rightId] = m_genealogy->AddCrossover(m_id, rhs.m_id, m_semantics, rhs.m_semantics, terminals);
+        SetId(leftId);
+        rhs.SetId(rightId);
+        SetModifiedBy(GeneticOperator::Crossover);
+        rhs.SetModifiedBy(GeneticOperator::Crossover);
+    }
+
+    IChromosome::INodePtr& SemanticChromosome::GetTree()
+    {
+        if (!m_tree)
+        {
+            m_tree = m_genealogy->Reconstruct(m_id);
+        }
+        return m_tree;
+    }
+
+    const IChromosome::INodePtr& SemanticChromosome::GetTree() const
+    {
+        if (!m_tree)
+        {
+            m_tree = m_genealogy->Reconstruct(m_id);
+        }
+        return m_tree;
+    }
+
+    std::string SemanticChromosome::ToString() const
+    {
+        if (m_size > MaxPrintedSize)
+        {
+            return Summary() + ", too large to print";
+        }
+        return GetTree()->ToString();
+    }
+
+    std::string SemanticChromosome::Summary() const
+    {
+        std::ostringstream output;
+        output << "individual " << m_id << " of size " << m_size;
+        return output.str();
+    }
+
+    void SemanticChromosome::Predict(std::vector<double>& predictionCases, std::vector<double>& terminals, int cutoff,
+            const RowPartition* rows) const
+    {
+        int columns = static_cast<int>(terminals.size()) + 1; // incl dependent variable
+        auto outputs = m_genealogy->Evaluate(m_id, predictionCases, terminals);
+        for (auto i = 0u; i < outputs.size(); ++i)
+        {
+            predictionCases[(i + 1)*columns - 1] = outputs[i];
+        }
+    }
+
+    void SemanticChromosome::SetId(int id)
+    {
+        // retain before releasing, since the old ID may be an ancestor of the new one
+        m_genealogy->Retain(id);
+        if (m_id >= 0)
+        {
+            m_genealogy->Release(m_id);
+        }
+        m_id = id;
+        m_size = m_genealogy->Size(id);
+        m_cost = m_size;
+        m_tree.reset();
+    }
+}
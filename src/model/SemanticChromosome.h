@@ -0,0 +1,110 @@
+#ifndef SemanticChromosome_H
+#define SemanticChromosome_H
+
+#include <memory>
+#include <vector>
+#include "Genealogy.h"
+#include "IChromosome.h"
+
+namespace Model
+{
+    /**
+     * An individual of a geometric semantic population. Rather than its S-expression, it holds its
+     * semantics (its output for each fitness case) and its ID in the Genealogy that records how it was made.
+     *
+     * Crossover and mutation are geometric semantic operators (see Genealogy), which take time linear in the
+     * number of fitness cases, however large the S-expressions. There is no geometric semantic hoist mutation,
+     * and S-expressions are never limited by TreeLimits, since offspring are larger than their parents by design.
+     */
+    class SemanticChromosome : public IChromosome
+    {
+    public:
+        /**
+         * Constructor - Adds an initial individual to the genealogy, and calculates its semantics but not its fitness
+         * @param genealogy The genealogy of the population
+         * @param tree The S-expression of the individual
+         * @param terminals The buffer to evaluate with, the same size as the genealogy's terminals
+         */
+        SemanticChromosome(std::shared_ptr<Genealogy> genealogy, IChromosome::INodePtr tree, std::vector<double>& terminals);
+
+        /**
+         * Copy Constructor. The S-expression is reconstructed when it's next needed.
+         */
+        SemanticChromosome(const SemanticChromosome& other);
+        SemanticChromosome& operator=(const SemanticChromosome&) = delete;
+
+        /**
+         * Destructor - Releases the individual's entry in the genealogy
+         */
+        ~SemanticChromosome();
+
+        /**
+         * Calculates the fitness (mean absolute error) and weighted fitness from the semantics
+         * @param fitnessCases The training data
+         * @param parsimonyCoefficient The coefficient used to penalise long chromosomes
+         */
+        void Evaluate(const std::vector<double>& fitnessCases, double parsimonyCoefficient);
+
+        /**
+         * @see IChromosome::Clone
+         */
+        std::unique_ptr<IChromosome> Clone() const override;
+
+        /**
+         * Geometric semantic mutation. The mutation table is unused, since the random S-expression
+         * is drawn from the genealogy's functions and terminals.
+         * @see IChromosome::Mutate
+         */
+        void Mutate(const MutationTable& mutations) override;
+
+        /**
+         * Does nothing, since there is no geometric semantic hoist mutation
+         */
+        void HoistMutate() override;
+
+        /**
+         * Geometric semantic crossover. The limits are ignored.
+         * @see IChromosome::Crossover
+         * @pre right is a SemanticChromosome of the same genealogy
+         */
+        void Crossover(IChromosome& right, const TreeLimits& limits) override;
+
+        /**
+         * @return the S-expression, reconstructed from the genealogy
+         */
+        IChromosome::INodePtr& GetTree() override;
+        const IChromosome::INodePtr& GetTree() const override;
+
+        /**
+         * @return the S-expression, or the Summary if it's too large to reconstruct
+         * @see IChromosome::ToString
+         */
+        std::string ToString() const override;
+
+        /**
+         * @return the ID and size of the individual, since its S-expression grows too large to reconstruct each
+         *         generation
+         */
+        std::string Summary() const override;
+
+        /**
+         * @see IChromosome::Predict
+         */
+        void Predict(std::vector<double>& predictionCases, std::vector<double>& terminals, int cutoff = 0,
+                const RowPartition* rows = nullptr) const override;
+
+    private:
+        /**
+         * Retains a new ID in the genealogy and releases the old one, updates the size, and forgets the
+         * reconstructed S-expression
+         */
+        void SetId(int id);
+
+        std::shared_ptr<Genealogy> m_genealogy; ///< The genealogy of the population, which outlives its individuals
+        int m_id = -1; ///< The ID of the individual in m_genealogy
+        std::vector<double> m_semantics; ///< The output of the S-expression for each fitness case
+        mutable IChromosome::INodePtr m_tree; ///< The S-expression, reconstructed upon demand. Null if not yet.
+    };
+}
+
+#endif
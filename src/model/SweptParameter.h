@@ -0,0 +1,19 @@
+#pragma once
+
+namespace Model
+{
+    /**
+     * A population parameter that a sweep may vary between configurations
+     */
+    enum class SweptParameter
+    {
+        PopulationSize = 0,   ///< PopulationParams::PopulationSize, rounded to an integer
+        TwinsPerMatingPair,   ///< PopulationParams::TwinsPerMatingPair, rounded to an integer
+        CarryOverProportion,  ///< PopulationParams::CarryOverProportion
+        ParsimonyCoefficient, ///< PopulationParams::ParsimonyCoefficient
+        CrossoverProb,        ///< PopulationParams::CrossoverProb
+        MutationProb,         ///< PopulationParams::MutationProb
+        HoistMutationProb,    ///< PopulationParams::HoistMutationProb
+        TarpeianRate          ///< PopulationParams::TarpeianRate
+    };
+}
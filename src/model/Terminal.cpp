@@ -1,24 +1,14 @@
 #include "Terminal.h"
 
 #include <stdexcept>
+#include <utility>
 
 namespace Model
 {
-    char Terminal::letter = 'a';
-    std::map<const double*, char> Terminal::s_symbols;
-
-    Terminal::Terminal(const double* variable)
+    Terminal::Terminal(const double* variable, std::string symbol)
         : m_variable(variable)
+        , m_symbol(std::move(symbol))
     {
-        if (s_symbols.find(variable) != s_symbols.end())
-        {
-            m_symbol = std::string({ s_symbols[variable], '\0' });
-        }
-        else
-        {
-            m_symbol = std::string({letter, '\0'});
-            s_symbols[variable] = letter++;
-        }
     }
 
     Terminal::Terminal(const Terminal& other)
@@ -27,11 +17,27 @@ namespace Model
     {
     }
 
+    const double* Terminal::GetVariable() const
+    {
+        return m_variable;
+    }
+
     double Terminal::Evaluate() const
     {
         return *m_variable;
     }
 
+    Util::Interval Terminal::EvaluateInterval(const VariableRanges& ranges) const
+    {
+        auto range = ranges.find(m_variable);
+        return range != ranges.end() ? range->second : Util::Interval{};
+    }
+
+    Util::Dual Terminal::EvaluateDual(const std::vector<const INode*>& seeds) const
+    {
+        return Util::Dual::Constant(*m_variable);
+    }
+
     std::string Terminal::ToString() const
     {
         return m_symbol.empty() ? std::to_string(*m_variable) : m_symbol;
@@ -81,6 +87,21 @@ namespace Model
         return std::make_unique<Terminal>(*this);
     }
 
+    std::size_t Terminal::Hash() const
+    {
+        return std::hash<const double*>{}(m_variable);
+    }
+
+    void Terminal::Rebind(const double* from, const double* to, std::size_t count)
+    {
+        // the symbol is unchanged, so the S-expression reads the same whichever buffer it points to
+        std::less<const double*> before;
+        if (!before(m_variable, from) && before(m_variable, from + count))
+        {
+            m_variable = to + (m_variable - from);
+        }
+    }
+
     std::string Terminal::GetSymbol() const
     {
         return m_symbol;
@@ -3,8 +3,8 @@
 
 #include <functional>
 #include <limits>
-#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "INode.h"
@@ -20,8 +20,9 @@ namespace Model
         /**
          * Constructor
          * @param variable A reference to the variable.
+         * @param symbol A symbolic representation of the variable, unique among the variables of a population
          */
-        Terminal(const double* variable);
+        Terminal(const double* variable, std::string symbol);
 
         Terminal(const Terminal& other);
 
@@ -32,6 +33,16 @@ namespace Model
          */
         double Evaluate() const override;
 
+        /**
+         * @see INode::EvaluateInterval
+         */
+        Util::Interval EvaluateInterval(const VariableRanges& ranges) const override;
+
+        /**
+         * @see INode::EvaluateDual
+         */
+        Util::Dual EvaluateDual(const std::vector<const INode*>& seeds) const override;
+
         /**
          * @return the string representation of this subtree.
          */
@@ -77,6 +88,21 @@ namespace Model
          */
         std::unique_ptr<INode> Clone() const override;
 
+        /**
+         * @see INode::Hash
+         */
+        std::size_t Hash() const override;
+
+        /**
+         * @see INode::Rebind
+         */
+        void Rebind(const double* from, const double* to, std::size_t count) override;
+
+        /**
+         * @return a pointer to the variable
+         */
+        const double* GetVariable() const;
+
     private:
         /**
          * @see INode::GetSymbol
@@ -85,9 +111,6 @@ namespace Model
 
         const double* m_variable; ///< A pointer to the terminal value
         std::string m_symbol; ///< A symbolic representation of the terminal
-
-        static char letter; ///< The symbol for the next terminal
-        static std::map<const double*, char> s_symbols; ///< Maps symbols to the terminal pointer
     };
 }
 #endif
@@ -4,7 +4,8 @@
 #include <memory>
 #include <vector>
 #include <Eigen/Dense>
-#include "IChromosome.h"
+#include "ChromosomeCore.h"
+#include "RowPartition.h"
 
 namespace Model
 {
@@ -15,9 +16,10 @@ namespace Model
      * for a single time series. Coefficients of the base terms are calculated by least-squares
      * estimation.
      */
-    class TimeSeriesChromosome : public IChromosome
+    class TimeSeriesChromosome : public ChromosomeCore<TimeSeriesChromosome>
     {
     public:
+        friend ChromosomeCore<TimeSeriesChromosome>;
 
         /**
          * Constructor - Creates a random TimeSeriesChromosome
@@ -32,7 +34,7 @@ namespace Model
         /**
          * Copy Constructor
          */
-        TimeSeriesChromosome(const TimeSeriesChromosome& other);
+        TimeSeriesChromosome(const TimeSeriesChromosome& other) = default;
 
         /**
          * Constructor - Does no fitness calculations upon construction
@@ -41,66 +43,18 @@ namespace Model
         // TimeSeriesChromosome(IChromosome::INodePtr tree);
 
         /**
-         * Constructor - Calculates fitness and weighted fitness upon construction.
+         * Constructor - Calculates fitness and weighted fitness upon construction. Unlike a Chromosome's, 
+         * evaluation is never cut off early: the only lower bound on the standard error is a least-squares fit
+         * to a subset of the rows, which costs more than the rows it saves.
+         * @param rows If set, the rows of the least-squares problem are built across its threads
          */
         TimeSeriesChromosome(IChromosome::INodePtr tree, const std::vector<double>& fitnessCases, 
-                std::vector<double>& terminals, double parsimonyCoefficient);
+                std::vector<double>& terminals, double parsimonyCoefficient, const RowPartition* rows = nullptr);
 
         /**
          * Constructor - Calculates only the weighted fitness upon construction.
          */
-        // TimeSeriesChromosome(IChromosome::INodePtr tree, double fitness, double parsimonyCoefficient);
-
-        /**
-         * Less-than operator. Used for sorting collections of Chromosomes.
-         */
-        bool operator<(const IChromosome& right) const override;
-
-        /**
-         * @see IChromosome::Size
-         */
-        int Size() const override;
-
-        /**
-         * @see IChromosome::Fitness
-         */
-        double Fitness() const override;
-
-        /**
-         * @see IChromosome::Clone
-         */
-        std::unique_ptr<IChromosome> Clone() const override;
-
-        /**
-         * @see IChromosome::Mutate
-         */
-        void Mutate(const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables) override;
-
-        /**
-         * @see IChromosome::HoistMutate
-         */
-        void HoistMutate() override;
-
-        /**
-         * @see IChromosome::Crossover
-         */
-        void Crossover(IChromosome& right) override;
-
-        /**
-         * @see IChromosome::GetTree
-         */
-        IChromosome::INodePtr& GetTree() override;
-        const IChromosome::INodePtr& GetTree() const override;
-
-        /**
-         * Creates a new, random chromosome
-         * @param targetSize The number of nodes in the chromosome tree we'd like. The
-         * number created is not deterministic, so targetSize acts as a minimum.
-         * @param allowedFunctions The set of functions allowed in the chromosome tree.
-         * @param variables The allowed set of terminals that may be selected from
-         * @return the root of the new chromosome
-         */
-        static std::unique_ptr<INode> CreateRandomChromosome(int targetSize, const std::vector<FunctionType>& allowedFunctions, const std::vector<double*>& variables);
+        TimeSeriesChromosome(IChromosome::INodePtr tree, double fitness, double parsimonyCoefficient);
 
         /**
          * @see IChromosome::ToString
@@ -113,30 +67,34 @@ namespace Model
         void Forecast(const std::vector<double>& fitnessCases, std::vector<double>& terminals, double* predictions, int length) const override;
 
         /**
+         * Each prediction is fed back as a terminal of the next, so rows are never split across threads.
          * @see IChromosome::Predict
          */
-        void Predict(std::vector<double>& predictionCases, std::vector<double>& terminals, int cutoff = 0) const override;
+        void Predict(std::vector<double>& predictionCases, std::vector<double>& terminals, int cutoff = 0,
+                const RowPartition* rows = nullptr) const override;
 
     private:
         /**
-         * Calculate the fitness for one chromosome. Currently uses MAE (mean absolute error)
+         * Calculate the fitness for one chromosome. Currently uses the standard error of the least-squares fit.
          * @param chromosome The chromosome to evaluate
+         * @param rows If set, the W matrix is built across its threads, though it is still solved by one
          * @return the chromosome fitness as a positive, real number
          */
-        double CalculateFitness(const std::vector<double>& fitnessCases, std::vector<double>& terminals) override;
+        double CalculateFitness(const std::vector<double>& fitnessCases, std::vector<double>& terminals,
+                const RowPartition* rows = nullptr);
 
-        double CalculateWeightedFitness(double parsimonyCoefficient) const override;
+        /**
+         * @return the root of a new, random S-expression. This is always an addition, since its children are the
+         * terms of the autoregressive model.
+         */
+        static std::unique_ptr<INode> CreateRoot(const std::vector<FunctionType>& allowedFunctions);
 
         /**
-         * @see IChromosome::SetSize
+         * Resizes the coefficients for the new number of terms in the S-expression
          */
-        void SetSize() override;
+        void OnTreeChanged();
 
-        IChromosome::INodePtr m_tree; ///< the S-expression
         Eigen::VectorXd m_coefficients; ///< Coefficients of the terms in the autoregressive model
-        int m_size; ///< the length (nodes in the tree)
-        double m_fitness = std::numeric_limits<double>::max(); ///< raw fitness of the chromosome.
-        double m_weightedFitness = std::numeric_limits<double>::max(); ///< weighted fitness, with penalty for length/size
     };
 }
 
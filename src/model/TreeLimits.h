@@ -0,0 +1,25 @@
+#ifndef TreeLimits_H
+#define TreeLimits_H
+
+namespace Model
+{
+    /**
+     * Hard limits on the shape of S-expressions, which genetic operators may not exceed.
+     */
+    struct TreeLimits
+    {
+        int MaxDepth = 0; ///< The maximum depth of any node, where the root is at depth 0. Unlimited if 0.
+        int MaxSize = 0; ///< The maximum number of nodes. Unlimited if 0.
+        int Retries = 0; ///< The number of times an operator may pick new points before the operation is rejected
+
+        /**
+         * @return true if an S-expression of the given depth and size is within the limits
+         */
+        bool Allow(int depth, int size) const
+        {
+            return (MaxDepth <= 0 || depth <= MaxDepth) && (MaxSize <= 0 || size <= MaxSize);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef Dual_H
+#define Dual_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace Util
+{
+    /**
+     * A dual number, a + b.e where e is a vector of infinitesimals whose products are zero, used for
+     * forward-mode automatic differentiation. Evaluating an expression on dual numbers yields both its value
+     * and its gradient with respect to each seeded input at once.
+     */
+    struct Dual
+    {
+        double Value = 0.0; ///< The value of the expression
+        std::vector<double> Derivatives; ///< The derivative with respect to each seeded input, by index. Empty if all are zero.
+
+        /**
+         * @return a dual number whose derivatives are zero
+         */
+        static Dual Constant(double value) { return { value, {} }; }
+
+        /**
+         * @return a dual number for a seeded input, whose derivative is 1 with respect to itself only
+         * @param index The index of the input
+         * @param inputs The number of seeded inputs
+         */
+        static Dual Seed(double value, std::size_t index, std::size_t inputs)
+        {
+            Dual seed{ value, std::vector<double>(inputs, 0.0) };
+            seed.Derivatives[index] = 1.0;
+            return seed;
+        }
+
+        /**
+         * @return the derivative with respect to a seeded input
+         */
+        double Derivative(std::size_t index) const { return index < Derivatives.size() ? Derivatives[index] : 0.0; }
+    };
+
+    /**
+     * @return da*a + db*b, for derivatives a and b, either of which may be empty (i.e. zero)
+     */
+    inline std::vector<double> Chain(double da, const std::vector<double>& a, double db, const std::vector<double>& b)
+    {
+        std::vector<double> result(std::max(a.size(), b.size()), 0.0);
+        for (auto i = 0u; i < a.size(); ++i)
+        {
+            result[i] += da * a[i];
+        }
+        for (auto i = 0u; i < b.size(); ++i)
+        {
+            result[i] += db * b[i];
+        }
+        return result;
+    }
+
+    /**
+     * @return da*a, for derivatives a, which may be empty (i.e. zero)
+     */
+    inline std::vector<double> Chain(double da, const std::vector<double>& a)
+    {
+        std::vector<double> result(a);
+        for (auto& derivative : result)
+        {
+            derivative *= da;
+        }
+        return result;
+    }
+
+    inline Dual operator-(const Dual& x)
+    {
+        return { -x.Value, Chain(-1.0, x.Derivatives) };
+    }
+
+    inline Dual operator+(const Dual& a, const Dual& b)
+    {
+        return { a.Value + b.Value, Chain(1.0, a.Derivatives, 1.0, b.Derivatives) };
+    }
+
+    inline Dual operator-(const Dual& a, const Dual& b)
+    {
+        return { a.Value - b.Value, Chain(1.0, a.Derivatives, -1.0, b.Derivatives) };
+    }
+
+    inline Dual operator*(const Dual& a, const Dual& b)
+    {
+        return { a.Value * b.Value, Chain(b.Value, a.Derivatives, a.Value, b.Derivatives) };
+    }
+
+    inline Dual operator/(const Dual& a, const Dual& b)
+    {
+        return { a.Value / b.Value, Chain(1.0 / b.Value, a.Derivatives, -a.Value / (b.Value * b.Value), b.Derivatives) };
+    }
+
+    /**
+     * @return |x|, taking the derivative at zero to be zero
+     */
+    inline Dual Abs(const Dual& x)
+    {
+        return x.Value < 0.0 ? -x : (x.Value > 0.0 ? x : Dual::Constant(0.0));
+    }
+
+    /**
+     * @return the square root of x, taking the derivative at zero to be zero
+     * @pre x is non-negative
+     */
+    inline Dual Sqrt(const Dual& x)
+    {
+        double root = std::sqrt(x.Value);
+        return root > 0.0 ? Dual{ root, Chain(1.0 / (2.0 * root), x.Derivatives) } : Dual::Constant(root);
+    }
+
+    inline Dual Sin(const Dual& x)
+    {
+        return { std::sin(x.Value), Chain(std::cos(x.Value), x.Derivatives) };
+    }
+
+    inline Dual Cos(const Dual& x)
+    {
+        return { std::cos(x.Value), Chain(-std::sin(x.Value), x.Derivatives) };
+    }
+
+    inline Dual Exp(const Dual& x)
+    {
+        double value = std::exp(x.Value);
+        return { value, Chain(value, x.Derivatives) };
+    }
+
+    /**
+     * @pre x is positive
+     */
+    inline Dual Log(const Dual& x)
+    {
+        return { std::log(x.Value), Chain(1.0 / x.Value, x.Derivatives) };
+    }
+}
+
+#endif
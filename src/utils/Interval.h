@@ -0,0 +1,269 @@
+#ifndef Interval_H
+#define Interval_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Util
+{
+    /**
+     * A closed interval [Lower, Upper] over the extended reals, used to bound the values a
+     * (sub)expression may take over a range of inputs.
+     *
+     * Bounds are rounded outward whenever the operands are not both single points, so the result
+     * of an operation always contains every value the corresponding floating-point calculation
+     * could produce. An interval with Lower > Upper is empty (e.g. only NaN can be produced).
+     */
+    struct Interval
+    {
+        double Lower = -std::numeric_limits<double>::infinity(); ///< The smallest attainable value
+        double Upper = std::numeric_limits<double>::infinity(); ///< The largest attainable value
+        bool MaybeNaN = false; ///< true if NaN may also be produced
+
+        /**
+         * @return an interval containing exactly one value
+         */
+        static Interval Point(double value) { return { value, value, std::isnan(value) }; }
+
+        /**
+         * @return an interval containing no values at all
+         */
+        static Interval Empty(bool maybeNaN = false)
+        {
+            return { std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), maybeNaN };
+        }
+
+        /**
+         * @return true if no (non-NaN) value can be produced
+         */
+        bool IsEmpty() const { return !(Lower <= Upper); }
+
+        /**
+         * @return true if the interval is a single, finite value, and can never be NaN
+         */
+        bool IsPoint() const { return Lower == Upper && std::isfinite(Lower) && !MaybeNaN; }
+
+        /**
+         * @return true if every attainable value is non-finite (i.e. +/-infinity or NaN)
+         */
+        bool IsNonFinite() const
+        {
+            return IsEmpty() ? MaybeNaN : (Lower == Upper && std::isinf(Lower));
+        }
+
+        /**
+         * @return true if the interval contains the value
+         */
+        bool Contains(double value) const { return Lower <= value && value <= Upper; }
+    };
+
+    namespace Detail
+    {
+        const double TwoPi = 2.0 * M_PI;
+
+        /**
+         * Rounds the finite bounds of a computed interval outwards by one ulp
+         */
+        inline Interval Outward(Interval x)
+        {
+            if (std::isfinite(x.Lower))
+            {
+                x.Lower = std::nextafter(x.Lower, -std::numeric_limits<double>::infinity());
+            }
+            if (std::isfinite(x.Upper))
+            {
+                x.Upper = std::nextafter(x.Upper, std::numeric_limits<double>::infinity());
+            }
+            return x;
+        }
+
+        /**
+         * Replaces NaN bounds (e.g. from inf - inf) with the widest possible bound
+         */
+        inline Interval Sanitise(Interval x)
+        {
+            if (std::isnan(x.Lower))
+            {
+                x.Lower = -std::numeric_limits<double>::infinity();
+                x.MaybeNaN = true;
+            }
+            if (std::isnan(x.Upper))
+            {
+                x.Upper = std::numeric_limits<double>::infinity();
+                x.MaybeNaN = true;
+            }
+            return x;
+        }
+
+        /**
+         * @return true if phase + 2k*pi lies within [lower, upper] for some integer k
+         */
+        inline bool ContainsPhase(double lower, double upper, double phase)
+        {
+            double k = std::ceil((lower - phase) / TwoPi);
+            return phase + k*TwoPi <= upper;
+        }
+
+        /**
+         * Applies a function with period 2*pi and range [-1, 1] to an interval.
+         * @param peak The phase at which f attains 1
+         * @param trough The phase at which f attains -1
+         */
+        template <typename Func>
+        Interval Periodic(const Interval& x, Func f, double peak, double trough)
+        {
+            if (x.IsEmpty())
+            {
+                return x;
+            }
+            if (std::isinf(x.Lower) && x.Lower == x.Upper)
+            {
+                return Interval::Empty(true); // e.g. sin(inf) is NaN
+            }
+            if (!std::isfinite(x.Lower) || !std::isfinite(x.Upper))
+            {
+                return { -1.0, 1.0, true };
+            }
+            if (x.IsPoint())
+            {
+                return Interval::Point(f(x.Lower));
+            }
+
+            Interval result = Outward({ std::min(f(x.Lower), f(x.Upper)), std::max(f(x.Lower), f(x.Upper)), x.MaybeNaN });
+            if (ContainsPhase(x.Lower, x.Upper, peak))
+            {
+                result.Upper = 1.0;
+            }
+            if (ContainsPhase(x.Lower, x.Upper, trough))
+            {
+                result.Lower = -1.0;
+            }
+            result.Lower = std::max(result.Lower, -1.0);
+            result.Upper = std::min(result.Upper, 1.0);
+            return result;
+        }
+    }
+
+    /**
+     * @return the smallest interval containing both a and b
+     */
+    inline Interval Hull(const Interval& a, const Interval& b)
+    {
+        return { std::min(a.Lower, b.Lower), std::max(a.Upper, b.Upper), a.MaybeNaN || b.MaybeNaN };
+    }
+
+    inline Interval operator-(const Interval& x)
+    {
+        return { -x.Upper, -x.Lower, x.MaybeNaN };
+    }
+
+    inline Interval operator+(const Interval& a, const Interval& b)
+    {
+        if (a.IsEmpty() || b.IsEmpty())
+        {
+            return Interval::Empty(a.MaybeNaN || b.MaybeNaN);
+        }
+
+        const double inf = std::numeric_limits<double>::infinity();
+        Interval result { a.Lower + b.Lower, a.Upper + b.Upper, a.MaybeNaN || b.MaybeNaN };
+        result.MaybeNaN |= (a.Lower == -inf && b.Upper == inf) || (a.Upper == inf && b.Lower == -inf);
+        result = Detail::Sanitise(result);
+        return (a.IsPoint() && b.IsPoint()) ? result : Detail::Outward(result);
+    }
+
+    inline Interval operator-(const Interval& a, const Interval& b)
+    {
+        return a + (-b);
+    }
+
+    inline Interval operator*(const Interval& a, const Interval& b)
+    {
+        if (a.IsEmpty() || b.IsEmpty())
+        {
+            return Interval::Empty(a.MaybeNaN || b.MaybeNaN);
+        }
+
+        const double corners[] = { a.Lower*b.Lower, a.Lower*b.Upper, a.Upper*b.Lower, a.Upper*b.Upper };
+        if (std::any_of(std::begin(corners), std::end(corners), [](double c) { return std::isnan(c); }))
+        {
+            return Interval{ -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), true }; // 0 * inf
+        }
+
+        Interval result { *std::min_element(std::begin(corners), std::end(corners)),
+                          *std::max_element(std::begin(corners), std::end(corners)),
+                          a.MaybeNaN || b.MaybeNaN };
+        return (a.IsPoint() && b.IsPoint()) ? result : Detail::Outward(result);
+    }
+
+    /**
+     * Divides two intervals.
+     * @pre The denominator does not contain zero.
+     */
+    inline Interval operator/(const Interval& a, const Interval& b)
+    {
+        if (a.IsEmpty() || b.IsEmpty())
+        {
+            return Interval::Empty(a.MaybeNaN || b.MaybeNaN);
+        }
+
+        const double corners[] = { a.Lower/b.Lower, a.Lower/b.Upper, a.Upper/b.Lower, a.Upper/b.Upper };
+        if (std::any_of(std::begin(corners), std::end(corners), [](double c) { return std::isnan(c); }))
+        {
+            return Interval{ -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), true }; // inf / inf
+        }
+
+        Interval result { *std::min_element(std::begin(corners), std::end(corners)),
+                          *std::max_element(std::begin(corners), std::end(corners)),
+                          a.MaybeNaN || b.MaybeNaN };
+        return (a.IsPoint() && b.IsPoint()) ? result : Detail::Outward(result);
+    }
+
+    /**
+     * @return the interval of |x|
+     */
+    inline Interval Abs(const Interval& x)
+    {
+        if (x.IsEmpty() || x.Lower >= 0.0)
+        {
+            return x;
+        }
+        if (x.Upper <= 0.0)
+        {
+            return -x;
+        }
+        return { 0.0, std::max(-x.Lower, x.Upper), x.MaybeNaN };
+    }
+
+    /**
+     * Applies a monotonically increasing function to an interval
+     */
+    template <typename Func>
+    Interval Increasing(const Interval& x, Func f)
+    {
+        if (x.IsEmpty())
+        {
+            return x;
+        }
+        Interval result = Detail::Sanitise({ f(x.Lower), f(x.Upper), x.MaybeNaN });
+        return x.IsPoint() ? result : Detail::Outward(result);
+    }
+
+    /**
+     * @return the interval of sin(x)
+     */
+    inline Interval Sine(const Interval& x)
+    {
+        return Detail::Periodic(x, [](double v) { return std::sin(v); }, M_PI_2, -M_PI_2);
+    }
+
+    /**
+     * @return the interval of cos(x)
+     */
+    inline Interval Cosine(const Interval& x)
+    {
+        return Detail::Periodic(x, [](double v) { return std::cos(v); }, 0.0, M_PI);
+    }
+}
+
+#endif
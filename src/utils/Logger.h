@@ -5,9 +5,11 @@
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <iterator>
 #include <string>
 #include <sstream>
 #include <tuple>
+#include <vector>
 
 namespace Util
 {
@@ -63,6 +65,17 @@ namespace Util
             m_entries.push_back(std::make_tuple(params ...));
         }
 
+        /**
+         * Moves the rows of another logger onto the end of this one's, such as to merge loggers filled on
+         * other threads
+         */
+        void Append(Logger& other)
+        {
+            m_entries.insert(m_entries.end(), std::make_move_iterator(other.m_entries.begin()), 
+                    std::make_move_iterator(other.m_entries.end()));
+            other.m_entries.clear();
+        }
+
         /**
          * Writes the stored values to file
          */
@@ -0,0 +1,75 @@
+#ifndef Mailbox_H
+#define Mailbox_H
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace Util
+{
+    /**
+     * A lock-free queue that any number of threads may post to, and one thread takes everything from at once.
+     * Items are pushed onto a linked list by compare-and-swap, and the list is taken by a single exchange,
+     * so neither side ever waits for the other.
+     */
+    template <typename T>
+    class Mailbox
+    {
+    public:
+        Mailbox() = default;
+        Mailbox(const Mailbox&) = delete;
+        Mailbox& operator=(const Mailbox&) = delete;
+
+        /**
+         * Destructor - discards any items not yet taken
+         */
+        ~Mailbox()
+        {
+            TakeAll();
+        }
+
+        /**
+         * Adds an item. May be called from several threads at once.
+         */
+        void Post(T item)
+        {
+            auto node = new Node{ std::move(item), m_head.load(std::memory_order_relaxed) };
+            while (!m_head.compare_exchange_weak(node->Next, node, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        /**
+         * Removes every item posted so far. Must only be called by one thread at a time.
+         * @return the items, in the order they were posted
+         */
+        std::vector<T> TakeAll()
+        {
+            std::vector<T> items;
+            auto node = m_head.exchange(nullptr, std::memory_order_acquire);
+            while (node)
+            {
+                items.push_back(std::move(node->Item));
+                auto next = node->Next;
+                delete node;
+                node = next;
+            }
+            std::reverse(items.begin(), items.end()); // the list is newest first
+            return items;
+        }
+
+    private:
+        /**
+         * An item in the list
+         */
+        struct Node
+        {
+            T Item; ///< The item posted
+            Node* Next; ///< The item posted before it, or nullptr
+        };
+
+        std::atomic<Node*> m_head{ nullptr }; ///< The item posted last, or nullptr if there are none
+    };
+}
+
+#endif
@@ -0,0 +1,149 @@
+#ifndef ThreadPool_H
+#define ThreadPool_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Util
+{
+    /**
+     * A fixed number of workers that run a job together. The calling thread is worker 0, and the rest are
+     * threads that live as long as the pool, so that a job (such as breeding a generation) doesn't pay for
+     * creating threads each time it is run.
+     */
+    class ThreadPool
+    {
+    public:
+        /**
+         * Constructor
+         * @param workers The number of workers, including the calling thread. At least 1.
+         */
+        explicit ThreadPool(int workers)
+            : m_workers(std::max(1, workers))
+            , m_errors(m_workers)
+        {
+            for (int w = 1; w < m_workers; ++w)
+            {
+                m_threads.emplace_back([this, w]() { Work(w); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * Destructor - waits for the workers to finish
+         */
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_start.notify_all();
+            for (auto& thread : m_threads)
+            {
+                thread.join();
+            }
+        }
+
+        /**
+         * @return the number of workers, including the calling thread
+         */
+        int Size() const { return m_workers; }
+
+        /**
+         * Runs a job on every worker, and waits until all have finished. Jobs aren't reentrant.
+         * If any worker throws, the exception of the lowest such worker is rethrown once all have finished.
+         * @param job Called once by each worker, with the index of the worker
+         */
+        void Run(const std::function<void(int worker)>& job)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_job = &job;
+                m_running = m_workers - 1;
+                std::fill(m_errors.begin(), m_errors.end(), nullptr);
+                ++m_generation;
+            }
+            m_start.notify_all();
+
+            try
+            {
+                job(0);
+            }
+            catch (...)
+            {
+                m_errors[0] = std::current_exception();
+            }
+
+            // the other workers still use the job, so wait for them even if worker 0 threw
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_finished.wait(lock, [this]() { return m_running == 0; });
+            m_job = nullptr;
+            for (const auto& error : m_errors)
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+
+    private:
+        /**
+         * The loop of each worker thread, which runs each job once
+         */
+        void Work(int worker)
+        {
+            long generation = 0;
+            while (true)
+            {
+                const std::function<void(int)>* job;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_start.wait(lock, [&]() { return m_stopping || m_generation != generation; });
+                    if (m_stopping)
+                    {
+                        return;
+                    }
+                    generation = m_generation;
+                    job = m_job;
+                }
+
+                try
+                {
+                    (*job)(worker);
+                }
+                catch (...)
+                {
+                    m_errors[worker] = std::current_exception(); // each worker has its own, so needn't lock
+                }
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (--m_running == 0)
+                {
+                    m_finished.notify_one();
+                }
+            }
+        }
+
+        const int m_workers; ///< The number of workers, including the calling thread
+        std::vector<std::thread> m_threads; ///< Workers 1 onwards
+        std::mutex m_mutex; ///< Guards the members below
+        std::condition_variable m_start; ///< Signals a new job, or that the pool is stopping
+        std::condition_variable m_finished; ///< Signals that the last worker thread has finished the job
+        const std::function<void(int)>* m_job = nullptr; ///< The current job
+        std::vector<std::exception_ptr> m_errors; ///< What each worker threw from the current job, if anything
+        long m_generation = 0; ///< The number of jobs run, so each worker runs each job once
+        int m_running = 0; ///< The number of worker threads yet to finish the current job
+        bool m_stopping = false; ///< Whether the workers should exit
+    };
+}
+
+#endif
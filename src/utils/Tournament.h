@@ -1,6 +1,7 @@
 #ifndef Tournament_H
 #define Tournament_H
 
+#include <algorithm>
 #include "ISelector.h"
 #include "UniformRandomGenerator.h"
 
@@ -22,7 +23,7 @@ namespace Util
          * Constructor
          */
         Tournament(int populationSize, int tournamentSize)
-            : m_randomIndex(0, tournamentSize) 
+            : m_randomIndex(0, std::max(0, std::min(tournamentSize, populationSize - 1))) // never beyond the population
             , m_populationSize(populationSize)
             , m_tournamentSize(tournamentSize)
         { }
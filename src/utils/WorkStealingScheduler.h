@@ -0,0 +1,209 @@
+#ifndef WorkStealingScheduler_H
+#define WorkStealingScheduler_H
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <vector>
+#include "ThreadPool.h"
+
+namespace Util
+{
+    /**
+     * Runs batches of tasks of uneven cost across a pool of workers.
+     *
+     * Tasks are dealt to the workers' queues largest first, each to the worker with the least estimated
+     * cost so far. Each worker runs its own queue from the largest task down, and once it's empty steals the
+     * smallest task from the worker with the most estimated cost left. So a few large tasks start early, and
+     * no worker idles while another has a queue of small ones behind a large one.
+     */
+    class WorkStealingScheduler
+    {
+    public:
+        /**
+         * How a worker has been used since the statistics were last reset
+         */
+        struct WorkerStatistics
+        {
+            double Busy = 0.0; ///< The time spent running tasks, in seconds
+            double Elapsed = 0.0; ///< The time spent running batches (busy or idle), in seconds
+            long Tasks = 0; ///< The number of tasks run
+            long Stolen = 0; ///< The number of those tasks stolen from other workers
+
+            /**
+             * @return the proportion of the elapsed time spent running tasks, in [0,1]
+             */
+            double Utilisation() const { return Elapsed > 0.0 ? std::min(1.0, Busy / Elapsed) : 0.0; }
+        };
+
+        /**
+         * Constructor
+         * @param workers The number of workers, including the calling thread. At least 1.
+         */
+        explicit WorkStealingScheduler(int workers)
+            : m_pool(workers)
+            , m_queues(m_pool.Size())
+            , m_statistics(m_pool.Size())
+        {
+        }
+
+        /**
+         * @return the number of workers, including the calling thread
+         */
+        int Size() const { return m_pool.Size(); }
+
+        /**
+         * @return the workers, to run other jobs between batches
+         */
+        ThreadPool& Pool() { return m_pool; }
+
+        /**
+         * Runs a batch of tasks, and waits until all have finished
+         * @param costs The estimated cost of each task, in any unit
+         * @param task Called once per task, with the index of the task and of the worker running it
+         */
+        void Run(const std::vector<double>& costs, const std::function<void(int task, int worker)>& task)
+        {
+            Deal(costs);
+
+            using Clock = std::chrono::steady_clock;
+            auto start = Clock::now();
+            m_pool.Run([&](int worker)
+            {
+                auto& statistics = m_statistics[worker];
+                int next;
+                bool stolen;
+                while (Next(worker, costs, next, stolen))
+                {
+                    auto begin = Clock::now();
+                    task(next, worker);
+                    std::chrono::duration<double> busy = Clock::now() - begin;
+
+                    statistics.Busy += busy.count();
+                    ++statistics.Tasks;
+                    statistics.Stolen += stolen ? 1 : 0;
+                }
+            });
+            std::chrono::duration<double> elapsed = Clock::now() - start;
+            for (auto& statistics : m_statistics)
+            {
+                statistics.Elapsed += elapsed.count();
+            }
+        }
+
+        /**
+         * @return how each worker has been used since the statistics were last reset, by worker index
+         */
+        const std::vector<WorkerStatistics>& Statistics() const { return m_statistics; }
+
+        /**
+         * Clears the statistics of each worker
+         */
+        void ResetStatistics()
+        {
+            std::fill(m_statistics.begin(), m_statistics.end(), WorkerStatistics{});
+        }
+
+    private:
+        /**
+         * The tasks dealt to a worker, largest first, and their total estimated cost
+         */
+        struct Queue
+        {
+            std::mutex Mutex; ///< Guards the members below, since other workers may steal from the queue
+            std::deque<int> Tasks; ///< The indices of the tasks, largest first
+            double Cost = 0.0; ///< The total estimated cost of the tasks
+        };
+
+        /**
+         * Deals the tasks to the workers' queues, largest first, each to the least loaded worker
+         */
+        void Deal(const std::vector<double>& costs)
+        {
+            std::vector<int> order(costs.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&costs](int a, int b) { return costs[a] > costs[b]; });
+
+            using Load = std::pair<double, int>; // total cost dealt, and worker
+            std::priority_queue<Load, std::vector<Load>, std::greater<Load>> loads;
+            for (int w = 0; w < Size(); ++w)
+            {
+                m_queues[w].Tasks.clear();
+                m_queues[w].Cost = 0.0;
+                loads.push({ 0.0, w });
+            }
+            for (auto task : order)
+            {
+                auto [load, worker] = loads.top();
+                loads.pop();
+                m_queues[worker].Tasks.push_back(task);
+                m_queues[worker].Cost += costs[task];
+                loads.push({ load + costs[task], worker });
+            }
+        }
+
+        /**
+         * Takes the next task for a worker: the largest in its own queue, or else one stolen from another
+         * @param worker The index of the worker
+         * @param task Set to the index of the task
+         * @param stolen Set to whether the task was stolen
+         * @return false if every queue is empty
+         */
+        bool Next(int worker, const std::vector<double>& costs, int& task, bool& stolen)
+        {
+            {
+                auto& own = m_queues[worker];
+                std::lock_guard<std::mutex> lock(own.Mutex);
+                if (!own.Tasks.empty())
+                {
+                    task = own.Tasks.front();
+                    own.Tasks.pop_front();
+                    own.Cost -= costs[task];
+                    stolen = false;
+                    return true;
+                }
+            }
+
+            // steal from the back of the queue with the most work left, retrying if it empties meanwhile
+            while (true)
+            {
+                int victim = -1;
+                double mostCost = -1.0;
+                for (int w = 0; w < Size(); ++w)
+                {
+                    std::lock_guard<std::mutex> lock(m_queues[w].Mutex);
+                    if (!m_queues[w].Tasks.empty() && m_queues[w].Cost > mostCost)
+                    {
+                        victim = w;
+                        mostCost = m_queues[w].Cost;
+                    }
+                }
+                if (victim < 0)
+                {
+                    return false; // tasks are never added during a batch, so the batch is done
+                }
+
+                auto& queue = m_queues[victim];
+                std::lock_guard<std::mutex> lock(queue.Mutex);
+                if (!queue.Tasks.empty())
+                {
+                    task = queue.Tasks.back();
+                    queue.Tasks.pop_back();
+                    queue.Cost -= costs[task];
+                    stolen = true;
+                    return true;
+                }
+            }
+        }
+
+        ThreadPool m_pool; ///< The workers
+        std::vector<Queue> m_queues; ///< The tasks of each worker, by worker index
+        std::vector<WorkerStatistics> m_statistics; ///< How each worker has been used, by worker index
+    };
+}
+
+#endif
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <memory>
+#include <string>
+#include "../src/model/Constant.h"
 #include "../src/model/Terminal.h"
 #include "../src/model/Function.h"
 #include "../src/model/FunctionFactory.h"
@@ -23,26 +25,26 @@ namespace Tests
     TEST_F(FunctionTest, Addition)
     {
         auto func = FunctionFactory::Create(FunctionType::Addition);
-        func->AddChild(std::make_unique<Terminal>(&a));
+        func->AddChild(std::make_unique<Terminal>(&a, "a"));
         ASSERT_DOUBLE_EQ(1.0, func->Evaluate());
 
-        func->AddChild(std::make_unique<Terminal>(&b));
+        func->AddChild(std::make_unique<Terminal>(&b, "b"));
         ASSERT_DOUBLE_EQ(3.0, func->Evaluate());
 
-        func->AddChild(std::make_unique<Terminal>(&c));
+        func->AddChild(std::make_unique<Terminal>(&c, "c"));
         ASSERT_DOUBLE_EQ(6.0, func->Evaluate());
     }
 
     TEST_F(FunctionTest, Subtraction)
     {
         auto func = FunctionFactory::Create(FunctionType::Subtraction);
-        func->AddChild(std::make_unique<Terminal>(&a));
+        func->AddChild(std::make_unique<Terminal>(&a, "a"));
         ASSERT_DOUBLE_EQ(1.0, func->Evaluate());
 
-        func->AddChild(std::make_unique<Terminal>(&b));
+        func->AddChild(std::make_unique<Terminal>(&b, "b"));
         ASSERT_DOUBLE_EQ(-1.0, func->Evaluate());
 
-        func->AddChild(std::make_unique<Terminal>(&c));
+        func->AddChild(std::make_unique<Terminal>(&c, "c"));
         ASSERT_DOUBLE_EQ(-4.0, func->Evaluate());
     }
 
@@ -50,15 +52,15 @@ namespace Tests
     {
         auto func = FunctionFactory::Create(FunctionType::Multiplication);
         ASSERT_EQ(1, func->Size());
-        func->AddChild(std::make_unique<Terminal>(&a));
+        func->AddChild(std::make_unique<Terminal>(&a, "a"));
         ASSERT_DOUBLE_EQ(1.0, func->Evaluate());
         ASSERT_EQ(2, func->Size());
 
-        func->AddChild(std::make_unique<Terminal>(&b));
+        func->AddChild(std::make_unique<Terminal>(&b, "b"));
         ASSERT_DOUBLE_EQ(2.0, func->Evaluate());
         ASSERT_EQ(3, func->Size());
 
-        func->AddChild(std::make_unique<Terminal>(&c));
+        func->AddChild(std::make_unique<Terminal>(&c, "c"));
         ASSERT_DOUBLE_EQ(6.0, func->Evaluate());
         ASSERT_EQ(4, func->Size());
     }
@@ -66,46 +68,46 @@ namespace Tests
     TEST_F(FunctionTest, Division)
     {
         auto func = FunctionFactory::Create(FunctionType::Division);
-        func->AddChild(std::make_unique<Terminal>(&a));
+        func->AddChild(std::make_unique<Terminal>(&a, "a"));
         ASSERT_DOUBLE_EQ(1.0, func->Evaluate());
         // TODO: no denominator .... should this be allowed?
 
-        func->AddChild(std::make_unique<Terminal>(&b));
+        func->AddChild(std::make_unique<Terminal>(&b, "b"));
         ASSERT_DOUBLE_EQ(0.5, func->Evaluate());
 
         func = FunctionFactory::Create(FunctionType::Division);
-        func->AddChild(std::make_unique<Terminal>(&c));
-        func->AddChild(std::make_unique<Terminal>(&a));
+        func->AddChild(std::make_unique<Terminal>(&c, "c"));
+        func->AddChild(std::make_unique<Terminal>(&a, "a"));
         ASSERT_DOUBLE_EQ(3.0, func->Evaluate());
 
         func = FunctionFactory::Create(FunctionType::Division);
-        ASSERT_TRUE(func->AddChild(std::make_unique<Terminal>(&c)));
-        ASSERT_TRUE(func->AddChild(std::make_unique<Terminal>(&b)));
+        ASSERT_TRUE(func->AddChild(std::make_unique<Terminal>(&c, "c")));
+        ASSERT_TRUE(func->AddChild(std::make_unique<Terminal>(&b, "b")));
         ASSERT_DOUBLE_EQ(1.5, func->Evaluate());
 
         // division can only have 2 children
-        ASSERT_FALSE(func->AddChild(std::make_unique<Terminal>(&b)));
+        ASSERT_FALSE(func->AddChild(std::make_unique<Terminal>(&b, "b")));
     }
 
     TEST_F(FunctionTest, SquareRoot)
     {
         auto func = FunctionFactory::Create(FunctionType::SquareRoot);
-        func->AddChild(std::make_unique<Terminal>(&a));
+        func->AddChild(std::make_unique<Terminal>(&a, "a"));
         ASSERT_DOUBLE_EQ(1.0, func->Evaluate());
 
         const double four = 4.0;
         func = FunctionFactory::Create(FunctionType::SquareRoot);
-        ASSERT_TRUE(func->AddChild(std::make_unique<Terminal>(&four)));
+        ASSERT_TRUE(func->AddChild(std::make_unique<Terminal>(&four, "four")));
         ASSERT_DOUBLE_EQ(2.0, func->Evaluate());
         ASSERT_EQ(2, func->Size());
 
         // sqrt can only have one child
-        ASSERT_FALSE(func->AddChild(std::make_unique<Terminal>(&b)));
+        ASSERT_FALSE(func->AddChild(std::make_unique<Terminal>(&b, "b")));
 
         // we're only dealing with real numbers, so sqrt should be of abs value
         const double minus = -1.0;
         func = FunctionFactory::Create(FunctionType::SquareRoot);
-        ASSERT_TRUE(func->AddChild(std::make_unique<Terminal>(&minus)));
+        ASSERT_TRUE(func->AddChild(std::make_unique<Terminal>(&minus, "minus")));
         ASSERT_DOUBLE_EQ(1.0, func->Evaluate());
     }
 
@@ -119,12 +121,12 @@ namespace Tests
         auto sub = FunctionFactory::Create(FunctionType::Subtraction);
 
         // (sqrt (/ (* b (+ a b c)) (- c b))) = sqrt(12)
-        add->AddChild(std::make_unique<Terminal>(&a));
-        add->AddChild(std::make_unique<Terminal>(&b));
-        add->AddChild(std::make_unique<Terminal>(&c));
-        sub->AddChild(std::make_unique<Terminal>(&c));
-        sub->AddChild(std::make_unique<Terminal>(&b));
-        mult->AddChild(std::make_unique<Terminal>(&b));
+        add->AddChild(std::make_unique<Terminal>(&a, "a"));
+        add->AddChild(std::make_unique<Terminal>(&b, "b"));
+        add->AddChild(std::make_unique<Terminal>(&c, "c"));
+        sub->AddChild(std::make_unique<Terminal>(&c, "c"));
+        sub->AddChild(std::make_unique<Terminal>(&b, "b"));
+        mult->AddChild(std::make_unique<Terminal>(&b, "b"));
         mult->AddChild(std::move(add));
         div->AddChild(std::move(mult));
         div->AddChild(std::move(sub));
@@ -140,12 +142,12 @@ namespace Tests
         auto mult = FunctionFactory::Create(FunctionType::Multiplication);
         auto add = FunctionFactory::Create(FunctionType::Addition);
         auto sub = FunctionFactory::Create(FunctionType::Subtraction);
-        add->AddChild(FunctionFactory::Create(&a));
-        add->AddChild(FunctionFactory::Create(&b));
-        add->AddChild(FunctionFactory::Create(&c));
-        sub->AddChild(FunctionFactory::Create(&c));
-        sub->AddChild(FunctionFactory::Create(&b));
-        mult->AddChild(FunctionFactory::Create(&b));
+        add->AddChild(FunctionFactory::Create(&a, "a"));
+        add->AddChild(FunctionFactory::Create(&b, "b"));
+        add->AddChild(FunctionFactory::Create(&c, "c"));
+        sub->AddChild(FunctionFactory::Create(&c, "c"));
+        sub->AddChild(FunctionFactory::Create(&b, "b"));
+        mult->AddChild(FunctionFactory::Create(&b, "b"));
         mult->AddChild(std::move(add));
         div->AddChild(std::move(mult));
         div->AddChild(std::move(sub));
@@ -177,10 +179,81 @@ namespace Tests
         ASSERT_DOUBLE_EQ(2.0, root->Get(10, root)->Evaluate()); // b
     }
 
+    TEST_F(FunctionTest, Hash)
+    {
+        // (+ a (* b c))
+        auto create = [this](const double* last, const char* symbol)
+        {
+            auto mult = FunctionFactory::Create(FunctionType::Multiplication);
+            mult->AddChild(FunctionFactory::Create(&b, "b"));
+            mult->AddChild(FunctionFactory::Create(last, symbol));
+            auto root = FunctionFactory::Create(FunctionType::Addition);
+            root->AddChild(FunctionFactory::Create(&a, "a"));
+            root->AddChild(std::move(mult));
+            return root;
+        };
+
+        auto tree = create(&c, "c");
+        ASSERT_EQ(tree->Hash(), create(&c, "c")->Hash());
+        ASSERT_EQ(tree->Hash(), tree->Clone()->Hash());
+        ASSERT_NE(tree->Hash(), create(&a, "a")->Hash());
+    }
+
+    TEST_F(FunctionTest, Cost)
+    {
+        // (e^ (+ a b)) costs the sum of its primitives, which is its size if every primitive costs 1
+        auto root = FunctionFactory::Create(FunctionType::NaturalExponential);
+        auto add = FunctionFactory::Create(FunctionType::Addition);
+        add->AddChild(FunctionFactory::Create(&a, "a"));
+        add->AddChild(FunctionFactory::Create(&b, "b"));
+        root->AddChild(std::move(add));
+        ASSERT_DOUBLE_EQ(4.0, root->Cost(CostTable()));
+
+        CostTable costs({ { FunctionType::NaturalExponential, 20.0 } }, 0.5);
+        ASSERT_DOUBLE_EQ(22.0, root->Cost(costs));
+        ASSERT_DOUBLE_EQ(22.0, root->Clone()->Cost(costs));
+
+        // measured costs are relative to addition
+        auto measured = CostTable::Calibrate({ FunctionType::Addition, FunctionType::NaturalExponential });
+        ASSERT_DOUBLE_EQ(1.0, measured.Of(FunctionType::Addition));
+        ASSERT_GT(measured.Of(FunctionType::NaturalExponential), 0.0);
+        ASSERT_GT(measured.Leaf(), 0.0);
+    }
+
+    TEST_F(FunctionTest, IndexNodes)
+    {
+        // (sqrt (/ (* b (+ a b c)) (- c b)))
+        auto root = FunctionFactory::Create(FunctionType::SquareRoot);
+        auto div = FunctionFactory::Create(FunctionType::Division);
+        auto mult = FunctionFactory::Create(FunctionType::Multiplication);
+        auto add = FunctionFactory::Create(FunctionType::Addition);
+        auto sub = FunctionFactory::Create(FunctionType::Subtraction);
+        add->AddChild(FunctionFactory::Create(&a, "a"));
+        add->AddChild(FunctionFactory::Create(&b, "b"));
+        add->AddChild(FunctionFactory::Create(&c, "c"));
+        sub->AddChild(FunctionFactory::Create(&c, "c"));
+        sub->AddChild(FunctionFactory::Create(&b, "b"));
+        mult->AddChild(FunctionFactory::Create(&b, "b"));
+        mult->AddChild(std::move(add));
+        div->AddChild(std::move(mult));
+        div->AddChild(std::move(sub));
+        root->AddChild(std::move(div));
+
+        // the index agrees with Get, in prefix order
+        NodeIndex index;
+        root->IndexNodes(root, index, 0);
+        ASSERT_EQ(11, index.Slots.size());
+        for (int i = 0; i < root->Size(); ++i)
+        {
+            ASSERT_EQ(&root->Get(i, root), index.Slots[i]);
+            ASSERT_EQ((*index.Slots[i])->Size(), index.Sizes[i]);
+        }
+    }
+
     TEST_F(FunctionTest, CloneSingleFunctionAndChild)
     {
         auto root = FunctionFactory::Create(FunctionType::Addition);
-        root->AddChild(FunctionFactory::Create(&a));
+        root->AddChild(FunctionFactory::Create(&a, "a"));
 
         auto clone = root->Clone();
         ASSERT_DOUBLE_EQ(root->Evaluate(), clone->Evaluate());
@@ -194,12 +267,12 @@ namespace Tests
         auto mult = FunctionFactory::Create(FunctionType::Multiplication);
         auto add = FunctionFactory::Create(FunctionType::Addition);
         auto sub = FunctionFactory::Create(FunctionType::Subtraction);
-        add->AddChild(FunctionFactory::Create(&a));
-        add->AddChild(FunctionFactory::Create(&b));
-        add->AddChild(FunctionFactory::Create(&c));
-        sub->AddChild(FunctionFactory::Create(&c));
-        sub->AddChild(FunctionFactory::Create(&b));
-        mult->AddChild(FunctionFactory::Create(&b));
+        add->AddChild(FunctionFactory::Create(&a, "a"));
+        add->AddChild(FunctionFactory::Create(&b, "b"));
+        add->AddChild(FunctionFactory::Create(&c, "c"));
+        sub->AddChild(FunctionFactory::Create(&c, "c"));
+        sub->AddChild(FunctionFactory::Create(&b, "b"));
+        mult->AddChild(FunctionFactory::Create(&b, "b"));
         mult->AddChild(std::move(add));
         div->AddChild(std::move(mult));
         div->AddChild(std::move(sub));
@@ -209,4 +282,158 @@ namespace Tests
         ASSERT_DOUBLE_EQ(root->Evaluate(), clone->Evaluate());
         ASSERT_EQ(root->ToString(), clone->ToString());
     }
+
+    TEST_F(FunctionTest, IntervalContainsEvaluation)
+    {
+        // (sqrt (/ (* b (+ a b c)) (- c b)))
+        auto root = FunctionFactory::Create(FunctionType::SquareRoot);
+        auto div = FunctionFactory::Create(FunctionType::Division);
+        auto mult = FunctionFactory::Create(FunctionType::Multiplication);
+        auto add = FunctionFactory::Create(FunctionType::Addition);
+        auto sub = FunctionFactory::Create(FunctionType::Subtraction);
+        add->AddChild(FunctionFactory::Create(&a, "a"));
+        add->AddChild(FunctionFactory::Create(&b, "b"));
+        add->AddChild(FunctionFactory::Create(&c, "c"));
+        sub->AddChild(FunctionFactory::Create(&c, "c"));
+        sub->AddChild(FunctionFactory::Create(&b, "b"));
+        mult->AddChild(FunctionFactory::Create(&b, "b"));
+        mult->AddChild(std::move(add));
+        div->AddChild(std::move(mult));
+        div->AddChild(std::move(sub));
+        root->AddChild(std::move(div));
+
+        VariableRanges ranges { { &a, { 0.5, 1.5 } }, { &b, { 1.0, 2.0 } }, { &c, { 3.0, 4.0 } } };
+        auto bounds = root->EvaluateInterval(ranges);
+        ASSERT_TRUE(bounds.Contains(root->Evaluate()));
+        ASSERT_FALSE(bounds.IsPoint());
+        ASSERT_FALSE(bounds.MaybeNaN);
+
+        // a single point for every variable gives exactly the evaluated value
+        VariableRanges points { { &a, Util::Interval::Point(a) }, { &b, Util::Interval::Point(b) }, { &c, Util::Interval::Point(c) } };
+        bounds = root->EvaluateInterval(points);
+        ASSERT_TRUE(bounds.IsPoint());
+        ASSERT_DOUBLE_EQ(root->Evaluate(), bounds.Lower);
+    }
+
+    TEST_F(FunctionTest, FoldProtectedDivision)
+    {
+        const double tiny = 0.0005;
+        auto root = FunctionFactory::Create(FunctionType::Addition);
+        auto div = FunctionFactory::Create(FunctionType::Division);
+        div->AddChild(FunctionFactory::Create(&a, "a"));
+        div->AddChild(FunctionFactory::Create(&tiny, "tiny"));
+        root->AddChild(std::move(div));
+        root->AddChild(FunctionFactory::Create(&b, "b"));
+
+        // the denominator never leaves the protected band, so (/ a tiny) is always 1
+        VariableRanges ranges { { &a, { -10.0, 10.0 } }, { &b, { 0.0, 5.0 } }, { &tiny, { -0.0009, 0.0009 } } };
+        auto bounds = root->FoldConstants(ranges);
+        ASSERT_EQ(3, root->Size());
+        ASSERT_EQ(0, root->Get(1, root)->MaxChildren());
+        ASSERT_DOUBLE_EQ(1.0, root->Get(1, root)->Evaluate());
+        ASSERT_DOUBLE_EQ(1.0 + b, root->Evaluate());
+        ASSERT_TRUE(bounds.Contains(root->Evaluate()));
+    }
+
+    TEST_F(FunctionTest, FoldProtectedLogarithm)
+    {
+        const double tiny = -0.0005;
+        auto root = FunctionFactory::Create(FunctionType::Multiplication);
+        auto log = FunctionFactory::Create(FunctionType::NaturalLogarithm);
+        log->AddChild(FunctionFactory::Create(&tiny, "tiny"));
+        root->AddChild(FunctionFactory::Create(&a, "a"));
+        root->AddChild(std::move(log));
+
+        VariableRanges ranges { { &a, { 0.0, 5.0 } }, { &tiny, { -0.0009, 0.0009 } } };
+        auto bounds = root->FoldConstants(ranges);
+        ASSERT_EQ(3, root->Size());
+        ASSERT_DOUBLE_EQ(0.0, root->Evaluate());
+        ASSERT_TRUE(bounds.Contains(0.0));
+    }
+
+    TEST_F(FunctionTest, ExponentialOverflowIsNonFinite)
+    {
+        const double large = 800.0;
+        auto root = FunctionFactory::Create(FunctionType::NaturalExponential);
+        root->AddChild(FunctionFactory::Create(&large, "large"));
+
+        VariableRanges ranges { { &large, { 750.0, 900.0 } } };
+        ASSERT_TRUE(root->EvaluateInterval(ranges).IsNonFinite());
+
+        // sin(inf) is NaN
+        auto sine = FunctionFactory::Create(FunctionType::Sine);
+        sine->AddChild(std::move(root));
+        ASSERT_TRUE(sine->EvaluateInterval(ranges).IsNonFinite());
+
+        // but not if some of the range is finite
+        ranges[&large] = { 0.0, 900.0 };
+        ASSERT_FALSE(sine->EvaluateInterval(ranges).IsNonFinite());
+    }
+
+    TEST_F(FunctionTest, DifferentiateWithRespectToConstant)
+    {
+        // d/dk (/ (sin (* k a)) (* c b)) = a*cos(k*a)/(c*b), and d/dc = -sin(k*a)/(c*c*b), in one pass
+        auto product = FunctionFactory::Create(FunctionType::Multiplication);
+        product->AddChild(std::make_unique<Constant>(0.5));
+        product->AddChild(FunctionFactory::Create(&a, "a"));
+        auto sine = FunctionFactory::Create(FunctionType::Sine);
+        sine->AddChild(std::move(product));
+        auto denominator = FunctionFactory::Create(FunctionType::Multiplication);
+        denominator->AddChild(std::make_unique<Constant>(2.0));
+        denominator->AddChild(FunctionFactory::Create(&b, "b"));
+        auto root = FunctionFactory::Create(FunctionType::Division);
+        root->AddChild(std::move(sine));
+        root->AddChild(std::move(denominator));
+
+        const auto* k = root->Get(3, root).get();
+        const auto* c = root->Get(6, root).get();
+        auto dual = root->EvaluateDual({ k, c });
+        ASSERT_DOUBLE_EQ(root->Evaluate(), dual.Value);
+        ASSERT_DOUBLE_EQ(a * std::cos(0.5 * a) / (2.0 * b), dual.Derivative(0));
+        ASSERT_DOUBLE_EQ(-std::sin(0.5 * a) / (4.0 * b), dual.Derivative(1));
+
+        // the derivative is zero with respect to anything else
+        ASSERT_DOUBLE_EQ(0.0, root->EvaluateDual({}).Derivative(0));
+        ASSERT_DOUBLE_EQ(0.0, root->EvaluateDual({ c }).Derivative(1));
+    }
+
+    TEST_F(FunctionTest, EphemeralRandomConstant)
+    {
+        auto constant = FunctionFactory::Create(nullptr, "");
+        ASSERT_EQ(0, constant->MaxChildren());
+        ASSERT_LE(-1.0, constant->Evaluate());
+        ASSERT_GE(1.0, constant->Evaluate());
+        ASSERT_DOUBLE_EQ(constant->Evaluate(), constant->Clone()->Evaluate());
+    }
+
+    TEST_F(FunctionTest, ConstantRoundTrips)
+    {
+        // printed constants read back exactly, yet as briefly as possible
+        ASSERT_EQ("0.1", Constant(0.1).ToString());
+        ASSERT_EQ("-2", Constant(-2.0).ToString());
+        for (double value : { 1.0 / 3.0, 0.1 + 0.2, 123456.789012345678, -7.0e-12 })
+        {
+            ASSERT_EQ(value, std::stod(Constant(value).ToString()));
+        }
+    }
+
+    TEST_F(FunctionTest, Rebind)
+    {
+        // (* x y 2), where x and y are in one buffer of terminals and a isn't
+        std::vector<double> terminals{ 2.0, 3.0 };
+        std::vector<double> scratch{ 5.0, 7.0 };
+        auto root = FunctionFactory::Create(FunctionType::Multiplication);
+        root->AddChild(std::make_unique<Terminal>(&terminals[0], "x"));
+        root->AddChild(std::make_unique<Terminal>(&terminals[1], "y"));
+        root->AddChild(std::make_unique<Terminal>(&a, "a"));
+        auto symbol = root->ToString();
+        ASSERT_DOUBLE_EQ(6.0, root->Evaluate());
+
+        root->Rebind(terminals.data(), scratch.data(), terminals.size());
+        ASSERT_DOUBLE_EQ(35.0, root->Evaluate());
+        ASSERT_EQ(symbol, root->ToString());
+
+        root->Rebind(scratch.data(), terminals.data(), scratch.size());
+        ASSERT_DOUBLE_EQ(6.0, root->Evaluate());
+    }
 }
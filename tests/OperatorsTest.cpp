@@ -3,6 +3,7 @@
 #include <memory>
 #include "../src/model/Chromosome.h"
 #include "../src/model/FunctionFactory.h"
+#include "../src/model/MutationTable.h"
 
 namespace
 {
@@ -22,45 +23,60 @@ namespace Tests
 
         // since there is only one node, and only one allowed function,
         // the mutation should change this to a sutraction
-        func.Mutate(allowedFunctions, allowedTerminals);
-        func.GetTree()->AddChild(FunctionFactory::Create(&B));
-        func.GetTree()->AddChild(FunctionFactory::Create(&A));
+        func.Mutate(MutationTable{ allowedFunctions, allowedTerminals });
+        func.GetTree()->AddChild(FunctionFactory::Create(&B, "B"));
+        func.GetTree()->AddChild(FunctionFactory::Create(&A, "A"));
         ASSERT_DOUBLE_EQ(B-A, func.GetTree()->Evaluate());
     }
 
     TEST(OperatorsTest, DontMutateWithOnlyOneTerminal)
     {
-        Chromosome var { FunctionFactory::Create(&A) };
+        Chromosome var { FunctionFactory::Create(&A, "A") };
         std::vector<FunctionType> allowedFunctions{};
         std::vector<double*> allowedTerminals{ &A };
 
         // since there is only one node (Terminal), and only one allowed terminal,
         // the mutation should change this to B.
-        var.Mutate(allowedFunctions, allowedTerminals);
+        var.Mutate(MutationTable{ allowedFunctions, allowedTerminals });
         ASSERT_DOUBLE_EQ(A, var.GetTree()->Evaluate());
     }
 
     TEST(OperatorsTest, MutationToOtherTerminal)
     {
-        Chromosome var { FunctionFactory::Create(&A) };
+        Chromosome var { FunctionFactory::Create(&A, "A") };
         std::vector<FunctionType> allowedFunctions{};
         std::vector<double*> allowedTerminals{ &A, &B };
 
         // since there is only one node (Terminal), and only one allowed terminal,
         // the mutation should change this to B.
-        var.Mutate(allowedFunctions, allowedTerminals);
+        var.Mutate(MutationTable{ allowedFunctions, allowedTerminals });
         ASSERT_DOUBLE_EQ(B, var.GetTree()->Evaluate());
     }
 
+    TEST(OperatorsTest, MutationToFunctionThatHoldsAllChildren)
+    {
+        auto tree = FunctionFactory::Create(FunctionType::Addition);
+        tree->AddChild(FunctionFactory::Create(&A, "A"));
+        tree->AddChild(FunctionFactory::Create(&B, "B"));
+
+        // a square root can't hold both children, so the only valid mutation is to a subtraction
+        MutationTable mutations { { FunctionType::SquareRoot, FunctionType::Subtraction }, { &A } };
+        for (int i = 0; i < 10; ++i)
+        {
+            mutations.Mutate(tree);
+            ASSERT_DOUBLE_EQ(A-B, tree->Evaluate());
+        }
+    }
+
     TEST(OperatorsTest, MutateEitherTerminalOrFunction)
     {
         double two = 2.0;
         double four = 4.0;
         Chromosome func { FunctionFactory::Create(FunctionType::Addition) };
-        func.GetTree()->AddChild(FunctionFactory::Create(&four));
+        func.GetTree()->AddChild(FunctionFactory::Create(&four, "four"));
         std::vector<FunctionType> allowedFunctions{ FunctionType::SquareRoot };
         std::vector<double*> allowedTerminals{ &two };
-        func.Mutate(allowedFunctions, allowedTerminals);
+        func.Mutate(MutationTable{ allowedFunctions, allowedTerminals });
 
         if (func.Size() > 2)
         {
@@ -76,7 +92,7 @@ namespace Tests
     {
         Chromosome root { FunctionFactory::Create(FunctionType::SquareRoot) };
         auto func = FunctionFactory::Create(FunctionType::SquareRoot);
-        func->AddChild(FunctionFactory::Create(&A));
+        func->AddChild(FunctionFactory::Create(&A, "A"));
         root.GetTree()->AddChild(std::move(func));
 
         while (root.Size() > 1)
@@ -97,6 +113,70 @@ namespace Tests
         }
     }
 
+    TEST(OperatorsTest, HoistMutateMarksModified)
+    {
+        auto tree = FunctionFactory::Create(FunctionType::SquareRoot);
+        auto func = FunctionFactory::Create(FunctionType::SquareRoot);
+        func->AddChild(FunctionFactory::Create(&A, "A"));
+        tree->AddChild(std::move(func));
+
+        Chromosome chromosome { std::move(tree) };
+        ASSERT_FALSE(chromosome.IsModified());
+        while (chromosome.Size() == 3)
+        {
+            chromosome.HoistMutate();
+        }
+        ASSERT_TRUE(chromosome.IsModified());
+        ASSERT_FALSE(chromosome.Clone()->IsModified());
+    }
+
+    TEST(OperatorsTest, CrossoverRejectedBeyondMaxSize)
+    {
+        // (+ A (+ A B)) and (+ A B)
+        auto inner = FunctionFactory::Create(FunctionType::Addition);
+        inner->AddChild(FunctionFactory::Create(&A, "A"));
+        inner->AddChild(FunctionFactory::Create(&B, "B"));
+        auto outer = FunctionFactory::Create(FunctionType::Addition);
+        outer->AddChild(FunctionFactory::Create(&A, "A"));
+        outer->AddChild(std::move(inner));
+        auto small = FunctionFactory::Create(FunctionType::Addition);
+        small->AddChild(FunctionFactory::Create(&A, "A"));
+        small->AddChild(FunctionFactory::Create(&B, "B"));
+        Chromosome left { std::move(outer) };
+        Chromosome right { std::move(small) };
+
+        // every crossover leaves one of the two with more than 3 nodes, so all are rejected
+        left.Crossover(right, TreeLimits{ 0, 3, 10 });
+        ASSERT_FALSE(left.IsModified());
+        ASSERT_FALSE(right.IsModified());
+        ASSERT_EQ(5, left.Size());
+        ASSERT_EQ(3, right.Size());
+    }
+
+    TEST(OperatorsTest, CrossoverWithinMaxDepth)
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            // (+ A B) and (+ A (+ A B))
+            auto shallow = FunctionFactory::Create(FunctionType::Addition);
+            shallow->AddChild(FunctionFactory::Create(&A, "A"));
+            shallow->AddChild(FunctionFactory::Create(&B, "B"));
+            auto inner = FunctionFactory::Create(FunctionType::Addition);
+            inner->AddChild(FunctionFactory::Create(&A, "A"));
+            inner->AddChild(FunctionFactory::Create(&B, "B"));
+            auto deep = FunctionFactory::Create(FunctionType::Addition);
+            deep->AddChild(FunctionFactory::Create(&A, "A"));
+            deep->AddChild(std::move(inner));
+            Chromosome left { std::move(shallow) };
+            Chromosome right { std::move(deep) };
+
+            // only terminals may move into the shallow tree, which must stay at depth 1
+            left.Crossover(right, TreeLimits{ 1, 0, 3 });
+            ASSERT_EQ(3, left.Size());
+            ASSERT_EQ(5, right.Size());
+        }
+    }
+
     TEST(OperatorsTest, TestFunctionThatCantHoldAllChildren)
     {
         // TODO: what happens when none of the allowed functions can
@@ -130,4 +210,23 @@ namespace Tests
         // std::cout << chromosome->ToString() << std::endl;
         // ASSERT_DOUBLE_EQ(A, chromosome->Evaluate());
     }
+
+    TEST(OperatorsTest, CreateFullRandomChromosome)
+    {
+        // functions are given their minimum children breadth-first, so (+ (+ (+ A A) (+ A A)) (+ (+ A A) (+ A A)))
+        std::vector<FunctionType> allowedFunctions{ FunctionType::Addition };
+        std::vector<double*> allowedTerminals{ &A };
+        auto chromosome = Chromosome::CreateRandomChromosome(7, allowedFunctions, allowedTerminals, true);
+        ASSERT_EQ(15, chromosome->Size());
+        ASSERT_DOUBLE_EQ(8*A, chromosome->Evaluate());
+    }
+
+    TEST(OperatorsTest, CreateLargeRandomChromosome)
+    {
+        // additions can always take more children, so the target size is always reached
+        std::vector<FunctionType> allowedFunctions{ FunctionType::Addition };
+        std::vector<double*> allowedTerminals{ &A, &B };
+        auto chromosome = Chromosome::CreateRandomChromosome(100'000, allowedFunctions, allowedTerminals);
+        ASSERT_LE(100'000, chromosome->Size());
+    }
 }
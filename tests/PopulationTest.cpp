@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
+#include <cmath>
+#include <functional>
+#include <set>
+#include <thread>
 #include "../src/model/FunctionFactory.h"
+#include "../src/model/SemanticChromosome.h"
 #include "../src/Population.h"
 
 namespace
@@ -8,7 +13,7 @@ namespace
     {
         Model::ChromosomeType::Normal,
         2, // population size
-        10, // The minimum tree size of newly (randomly) created S-expressions
+        1, // The minimum tree size of newly (randomly) created S-expressions, so all are (sqrt a)
         0.7, // crossover probability
         0.001, // mutation probability
         0.001, // hoist mutation probability
@@ -72,8 +77,104 @@ namespace Tests
     class PopulationTest : public ::testing::Test
     {
     public:
-        const std::vector<std::unique_ptr<IChromosome>>& AccessPopulation(const Population& p) { return p.m_population; }
+        const PopulationStore& AccessPopulation(const Population& p) { return p.m_population; }
         static double WeightedFitness(const Chromosome& c) { return c.m_weightedFitness; }
+        static auto GetNewOffspring(Population& p, const IChromosome& mum, const IChromosome& dad, double parsimony)
+        {
+            return p.GetNewOffspring(mum, dad, p.m_workers[0], parsimony, std::numeric_limits<double>::max());
+        }
+        static std::vector<double>& Terminals(Population& p) { return *p.m_terminals; }
+        static const PopulationStore& Island(const Population& p, int i) { return p.m_islands[i]->m_population; }
+        static int Islands(const Population& p) { return static_cast<int>(p.m_islands.size()); }
+        static int BredAhead(const Population& p) { return static_cast<int>(p.m_bredAhead.size()); }
+        static auto TakeMigrants(Population& p, int generation, int island) 
+        { 
+            return p.m_mailboxes[(generation % 2) * p.m_islands.size() + island].TakeAll(); 
+        }
+        static void Reproduce(Population& p, const IChromosome& mum, const IChromosome& dad, PopulationStore& nextGeneration)
+        {
+            for (auto& child : p.Reproduce(mum, dad, p.m_workers[0]))
+            {
+                nextGeneration.Add(std::move(child));
+            }
+        }
+
+        /**
+         * @return the parameters of a seeded population, large enough to breed across several threads
+         */
+        static PopulationParams SeededParams()
+        {
+            auto params = Params2;
+            params.PopulationSize = 40;
+            params.Seed = 7;
+            params.Threads = 4;
+            params.MutationProb = 0.2;
+            return params;
+        }
+
+        /**
+         * Resets a population, then evolves it for a few generations
+         */
+        static void ResetAndEvolve(Population& p, int generations = 3)
+        {
+            p.Reset();
+            for (int i = 0; i < generations; ++i)
+            {
+                p.Evolve();
+            }
+        }
+
+        /**
+         * @return the size and fitness of each individual of a population, or of each of its islands in turn
+         */
+        static std::vector<std::pair<int, double>> Individuals(const Population& p)
+        {
+            std::vector<std::pair<int, double>> individuals;
+            auto add = [&individuals](const PopulationStore& population)
+            {
+                for (int i = 0; i < population.Size(); ++i)
+                {
+                    individuals.emplace_back(population[i].Size(), population[i].Fitness());
+                }
+            };
+            if (p.m_islands.empty())
+            {
+                add(p.m_population);
+            }
+            for (const auto& island : p.m_islands)
+            {
+                add(island->m_population);
+            }
+            return individuals;
+        }
+
+        /**
+         * Evolves a new population for a few generations, to compare seeded runs
+         * @return the size and fitness of each of its individuals
+         */
+        static std::vector<std::pair<int, double>> RunSeeded(const PopulationParams& params, int generations = 3)
+        {
+            Population p{params, FitnessCases2};
+            ResetAndEvolve(p, generations);
+            return Individuals(p);
+        }
+
+        /**
+         * Asserts that each individual's fitness is what it evaluates to with the population's own terminals, 
+         * whichever worker's terminals it was evaluated with
+         */
+        void AssertFitnessOwnTerminals(Population& p)
+        {
+            const auto& population = AccessPopulation(p);
+            for (int i = 0; i < population.Size(); ++i)
+            {
+                Chromosome reference{ population[i].GetTree()->Clone(), FitnessCases2, Terminals(p), 0.0 };
+                if (population[i].Fitness() != std::numeric_limits<double>::max())
+                {
+                    ASSERT_DOUBLE_EQ(reference.Fitness(), population[i].Fitness());
+                }
+            }
+        }
     protected:
         PopulationTest() { }
 
@@ -86,24 +187,157 @@ namespace Tests
     TEST_F(PopulationTest, ChromosomeConstructor) 
     {
         // population is empty until Reset
-        ASSERT_EQ(0, AccessPopulation(p1).size());
+        ASSERT_EQ(0, AccessPopulation(p1).Size());
         p1.Reset();
 
         // All chromosomes in p1 are guaranteed to be (sqrt a)
-        ASSERT_DOUBLE_EQ(12.992451294754199, AccessPopulation(p1)[0]->Fitness());
+        ASSERT_DOUBLE_EQ(12.992451294754199, AccessPopulation(p1)[0].Fitness());
     }
 
     TEST_F(PopulationTest, ChromosomeFitness) 
     {
         // test CalculateFitness and CalculateWeightedFitness
+        std::vector<double> terminals(1);
+        auto sqrtA = [&terminals]() 
+        {
+            auto root = FunctionFactory::Create(FunctionType::SquareRoot);
+            root->AddChild(FunctionFactory::Create(&terminals[0], "a"));
+            return root;
+        };
+
+        const double parsimony = 0.5;
+        Chromosome full { sqrtA(), FitnessCases1, terminals, parsimony };
+        ASSERT_DOUBLE_EQ(12.992451294754199, full.Fitness());
+        ASSERT_DOUBLE_EQ(12.992451294754199 + parsimony*2, WeightedFitness(full));
+
+        // evaluation stops early once the weighted fitness can't beat the cutoff
+        const double cutoff = 5.0;
+        Chromosome bounded { sqrtA(), FitnessCases1, terminals, parsimony, cutoff };
+        ASSERT_GT(WeightedFitness(bounded), cutoff);
+        ASSERT_LT(bounded.Fitness(), full.Fitness());
+    }
+
+    TEST_F(PopulationTest, ChromosomeCost)
+    {
+        // the parsimony coefficient penalises the cost of (sqrt a), rather than its size
+        auto params = Params1;
+        params.CostParsimony = true;
+        params.PrimitiveCosts = { { FunctionType::SquareRoot, 10.0 } };
+        Population p3{params, FitnessCases1};
+        p3.Reset();
+
+        const auto& sqrtA = AccessPopulation(p3)[0];
+        ASSERT_EQ(2, sqrtA.Size());
+        ASSERT_DOUBLE_EQ(11.0, sqrtA.Cost());
+        ASSERT_DOUBLE_EQ(11.0, AccessPopulation(p3).Costs()[0]);
+
+        auto clone = sqrtA.Clone();
+        clone->Reweigh(0.5);
+        ASSERT_DOUBLE_EQ(11.0, clone->Cost());
+        ASSERT_DOUBLE_EQ(12.992451294754199 + 0.5*11.0, clone->WeightedFitness());
+    }
+
+    TEST_F(PopulationTest, ChromosomeLinearScaling)
+    {
+        // y = 3a + 2 is fitted exactly by scaling the S-expression a
+        std::vector<double> terminals(1);
+        std::vector<double> cases { 1, 5, 2, 8, 3, 11, 4, 14, 5, 17 };
+        Chromosome unscaled { FunctionFactory::Create(&terminals[0], "a"), cases, terminals, 0.0 };
+        Chromosome scaled { FunctionFactory::Create(&terminals[0], "a"), cases, terminals, 0.0,
+            std::numeric_limits<double>::max(), true };
+        ASSERT_DOUBLE_EQ(8.0, unscaled.Fitness());
+        ASSERT_NEAR(0.0, scaled.Fitness(), 1e-12);
+
+        std::vector<double> predictions { 6, 0, 10, 0 };
+        scaled.Predict(predictions, terminals);
+        ASSERT_NEAR(20.0, predictions[1], 1e-12);
+        ASSERT_NEAR(32.0, predictions[3], 1e-12);
+    }
+
+    TEST_F(PopulationTest, ChromosomeRowParallelFitness)
+    {
+        // several chunks of rows, the last of them partial
+        std::vector<double> terminals(1);
+        std::vector<double> cases;
+        for (int i = 0; i < 5 * RowPartition::ChunkRows + 17; ++i)
+        {
+            double a = i % 97 + 1.0;
+            cases.insert(cases.end(), { a, 3.0 * a + std::sin(i) });
+        }
+        auto sqrtA = [&terminals]() 
+        {
+            auto root = FunctionFactory::Create(FunctionType::SquareRoot);
+            root->AddChild(FunctionFactory::Create(&terminals[0], "a"));
+            return root;
+        };
+
+        // splitting the rows across threads gives the same fitness as evaluating them in turn
+        Util::ThreadPool pool(4);
+        RowPartition rows(pool, terminals);
+        const auto max = std::numeric_limits<double>::max();
+        for (bool linearScaling : { false, true })
+        {
+            Chromosome serial { sqrtA(), cases, terminals, 0.0, max, linearScaling };
+            Chromosome parallel { sqrtA(), cases, terminals, 0.0, max, linearScaling, &rows };
+            ASSERT_NEAR(serial.Fitness(), parallel.Fitness(), 1e-9 * serial.Fitness());
+
+            auto serialPredictions = cases;
+            auto parallelPredictions = cases;
+            serial.Predict(serialPredictions, terminals);
+            parallel.Predict(parallelPredictions, terminals, 0, &rows);
+            for (auto i = 1u; i < cases.size(); i += 2)
+            {
+                ASSERT_NEAR(serialPredictions[i], parallelPredictions[i], 1e-9);
+            }
+
+            // and stops early once the fitness can't beat the cutoff
+            const double cutoff = 0.5 * serial.Fitness();
+            Chromosome bounded { sqrtA(), cases, terminals, 0.0, cutoff, linearScaling, &rows };
+            ASSERT_GT(bounded.Fitness(), cutoff);
+            ASSERT_LE(bounded.Fitness(), serial.Fitness() * (1.0 + 1e-9));
+        }
+    }
+
+    TEST_F(PopulationTest, ChromosomeTuneConstants)
+    {
+        // (* k (sqrt a)) fitted to 2.5*sqrt(a), over several chunks of rows
+        std::vector<double> terminals(1);
+        std::vector<double> cases;
+        for (int i = 0; i < 3 * RowPartition::ChunkRows + 17; ++i)
+        {
+            double a = i % 97 + 1.0;
+            cases.insert(cases.end(), { a, 2.5 * std::sqrt(a) + 0.01 * std::sin(i) });
+        }
+        auto params = Params1;
+        params.AllowedFunctions = { FunctionType::Multiplication, FunctionType::SquareRoot };
+        std::vector<double*> variables{ &terminals[0] };
+        ChromosomeFactory factory{ params, variables, variables, cases, terminals };
+
+        auto root = FunctionFactory::Create(FunctionType::Multiplication);
+        root->AddChild(std::make_unique<Constant>(1.0));
+        auto sqrtA = FunctionFactory::Create(FunctionType::SquareRoot);
+        sqrtA->AddChild(FunctionFactory::Create(&terminals[0], "a"));
+        root->AddChild(std::move(sqrtA));
+        auto untuned = factory.CopyAndEvaluate(std::move(root), 0.0);
+
+        // the constant is tuned, and the same whether or not the rows are split across threads
+        std::vector<double> buffer(1);
+        Util::ThreadPool pool(4);
+        RowPartition rows(pool, terminals);
+        auto serial = factory.TuneConstants(*untuned, 0.0, buffer);
+        auto parallel = factory.TuneConstants(*untuned, 0.0, buffer, &rows);
+        ASSERT_TRUE(serial && parallel);
+        ASSERT_LT(serial->Fitness(), 0.02);
+        ASSERT_EQ(serial->ToString(), parallel->ToString());
+        ASSERT_NEAR(2.5, std::stod(serial->GetTree()->GetChildren()[0]->ToString()), 1e-3);
     }
 
     TEST_F(PopulationTest, ChromosomeOperatorLessThan) 
     {
         p2.Reset();
         // test that operator< works properly
-        const auto& c1 = dynamic_cast<Chromosome*>(AccessPopulation(p2)[0].get());
-        const auto& c2 = dynamic_cast<Chromosome*>(AccessPopulation(p2)[1].get());
+        const auto& c1 = dynamic_cast<const Chromosome*>(&AccessPopulation(p2)[0]);
+        const auto& c2 = dynamic_cast<const Chromosome*>(&AccessPopulation(p2)[1]);
 
         // Less than operator includes parsimony coefficient
         ASSERT_EQ(WeightedFitness(*c1) < WeightedFitness(*c2), *c1 < *c2);
@@ -111,15 +345,72 @@ namespace Tests
         ASSERT_FALSE(WeightedFitness(*c2) < WeightedFitness(*c2));
     }
 
+    TEST_F(PopulationTest, ChromosomeClone)
+    {
+        p2.Reset();
+        auto original = AccessPopulation(p2)[0].Clone();
+        auto partner = AccessPopulation(p2)[1].Clone();
+        original->Crossover(*partner, TreeLimits{});
+        ASSERT_TRUE(original->IsModified());
+        ASSERT_TRUE(original->IsModifiedBy(GeneticOperator::Crossover));
+        ASSERT_FALSE(original->IsModifiedBy(GeneticOperator::Mutation));
+
+        // clones keep the fitness, but not the modified flag, of the original
+        auto clone = original->Clone();
+        ASSERT_FALSE(clone->IsModified());
+        ASSERT_EQ(original->ToString(), clone->ToString());
+        ASSERT_EQ(original->Size(), clone->Size());
+        ASSERT_DOUBLE_EQ(original->WeightedFitness(), clone->WeightedFitness());
+
+        // and have their own S-expression
+        ASSERT_NE(original->GetTree().get(), clone->GetTree().get());
+    }
+
     TEST_F(PopulationTest, PopulationConstructor) 
     {
-        ASSERT_EQ(0, AccessPopulation(p1).size());
-        ASSERT_EQ(0, AccessPopulation(p2).size());
+        ASSERT_EQ(0, AccessPopulation(p1).Size());
+        ASSERT_EQ(0, AccessPopulation(p2).Size());
         p1.Reset();
         p2.Reset();
 
-        ASSERT_EQ(Params1.PopulationSize, AccessPopulation(p1).size());
-        ASSERT_EQ(Params2.PopulationSize, AccessPopulation(p2).size());
+        ASSERT_EQ(Params1.PopulationSize, AccessPopulation(p1).Size());
+        ASSERT_EQ(Params2.PopulationSize, AccessPopulation(p2).Size());
+    }
+
+    TEST_F(PopulationTest, PopulationResetUnique)
+    {
+        // the initial S-expressions are all different, when there are enough to choose from
+        auto params = Params2;
+        params.PopulationSize = 50;
+        params.Initialisation = InitialisationMethod::Ramped;
+        params.Threads = 4;
+        Population p3{params, FitnessCases2};
+        p3.Reset();
+
+        std::set<std::string> expressions;
+        for (int id = 0; id < AccessPopulation(p3).Size(); ++id)
+        {
+            expressions.insert(AccessPopulation(p3)[id].ToString());
+        }
+        ASSERT_EQ(50, expressions.size());
+
+        // and ramped up to the depth of a full binary tree of twice the minimum size (20 nodes)
+        std::function<int(const INode&)> depth = [&depth](const INode& node)
+        {
+            int deepest = 0;
+            for (int i = 0; i < node.NumberOfChildren(); ++i)
+            {
+                deepest = std::max(deepest, 1 + depth(*node.GetChildren()[i]));
+            }
+            return deepest;
+        };
+        std::set<int> depths;
+        for (int id = 0; id < AccessPopulation(p3).Size(); ++id)
+        {
+            depths.insert(depth(*AccessPopulation(p3)[id].GetTree()));
+        }
+        ASSERT_EQ(4, *depths.rbegin());
+        ASSERT_GT(depths.size(), 1u);
     }
 
     TEST_F(PopulationTest, PopulationReset) 
@@ -135,6 +426,174 @@ namespace Tests
         // test that the new population is correct, as per the stored params
     }
 
+    TEST_F(PopulationTest, PopulationEvolveInParallel) 
+    {
+        // offspring are bred across the workers, and evaluated with their own terminals
+        auto params = SeededParams();
+        Population p{params, FitnessCases2};
+        ResetAndEvolve(p);
+        ASSERT_EQ(params.PopulationSize, AccessPopulation(p).Size());
+        AssertFitnessOwnTerminals(p);
+
+        // with the same seed and number of threads, workers breed the same generations
+        ASSERT_EQ(Individuals(p), RunSeeded(params));
+    }
+
+    TEST_F(PopulationTest, PopulationIslands) 
+    {
+        auto params = SeededParams();
+        params.PopulationSize = 42;
+        params.Threads = 2;
+        params.Islands = 4;
+        params.MigrationInterval = 2;
+        params.Migrants = 2;
+
+        // the population is split evenly between the islands
+        Population p{params, FitnessCases2};
+        p.Reset();
+        ASSERT_EQ(4, Islands(p));
+        ASSERT_EQ(11, Island(p, 0).Size());
+        ASSERT_EQ(10, Island(p, 3).Size());
+
+        // islands keep to themselves between migrations
+        p.Evolve();
+        for (int i = 0; i < Islands(p); ++i)
+        {
+            ASSERT_TRUE(TakeMigrants(p, 0, i).empty());
+        }
+
+        // then each sends its fittest to the next around the ring
+        p.Evolve();
+        for (int i = 0; i < Islands(p); ++i)
+        {
+            auto migrants = TakeMigrants(p, 1, (i + 1) % Islands(p));
+            ASSERT_EQ(2u, migrants.size());
+            for (const auto& migrant : migrants)
+            {
+                ASSERT_EQ(i, migrant.Island);
+                const auto& sender = Island(p, i);
+                ASSERT_EQ(sender[sender.ByWeightedFitness()[migrant.Rank]].Fitness(), migrant.Individual->Fitness());
+            }
+        }
+
+        // the best of any island is the best of the population
+        auto [ min, firstQtr, median, thirdQtr, max ] = p.GetRangeStatistics();
+        ASSERT_DOUBLE_EQ(min, p.GetBestFit()->Fitness());
+        ASSERT_LE(min, p.GetAverageFitness());
+
+        // migration doesn't depend on which thread evolves which island
+        params.MigrationInterval = 1;
+        params.Topology = MigrationTopology::FullyConnected;
+        ASSERT_EQ(RunSeeded(params, 4), RunSeeded(params, 4));
+    }
+
+    TEST_F(PopulationTest, PopulationReplicas) 
+    {
+        auto params = SeededParams();
+        std::vector<PopulationParams> replicaParams(3, params);
+        replicaParams[0].Seed = replicaParams[1].Seed = 3;
+        replicaParams[2].Seed = 5;
+        replicaParams[2].Threads = 2;
+
+        // replicas share the fitness cases, but nothing mutable, so can evolve at the same time
+        Population mainland{params, FitnessCases2};
+        auto replicas = mainland.Replicate(replicaParams);
+        std::vector<std::thread> threads;
+        for (auto& replica : replicas)
+        {
+            threads.emplace_back([&replica]() { ResetAndEvolve(*replica); });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        // and evolve as they would alone, so replicas with the same seed evolve the same way
+        ASSERT_EQ(params.PopulationSize, AccessPopulation(*replicas[2]).Size());
+        ASSERT_EQ(Individuals(*replicas[0]), Individuals(*replicas[1]));
+        ASSERT_EQ(Individuals(*replicas[2]), RunSeeded(replicaParams[2]));
+    }
+
+    TEST_F(PopulationTest, PopulationSteadyState) 
+    {
+        auto params = SeededParams();
+        params.SteadyState = true;
+
+        // offspring only replace losers they are fitter than, so the fittest is never lost
+        Population p{params, FitnessCases2};
+        p.Reset();
+        for (int i = 0; i < 5; ++i)
+        {
+            const auto& population = AccessPopulation(p);
+            double fittest = population.WeightedFitness()[population.ByWeightedFitness()[0]];
+            p.Evolve();
+            ASSERT_EQ(params.PopulationSize, population.Size());
+            ASSERT_LE(population.WeightedFitness()[population.ByWeightedFitness()[0]], fittest);
+        }
+
+        // the least fit are replaced first
+        params.Threads = 1;
+        params.ReplaceWorst = true;
+        Population worst{params, FitnessCases2};
+        worst.Reset();
+        const auto& population = AccessPopulation(worst);
+        double leastFit = population.WeightedFitness()[population.ByWeightedFitness().back()];
+        worst.Evolve();
+        ASSERT_LE(population.WeightedFitness()[population.ByWeightedFitness().back()], leastFit);
+    }
+
+    TEST_F(PopulationTest, PopulationPipelined) 
+    {
+        auto params = SeededParams();
+        params.CarryOverProportion = 0.0;
+        params.PipelineLag = 0.25;
+
+        // each generation breeds a quarter of the next one's 20 families ahead, and evaluates them in its own
+        Population p{params, FitnessCases2};
+        ResetAndEvolve(p);
+        ASSERT_EQ(5, BredAhead(p));
+        ASSERT_EQ(params.PopulationSize, AccessPopulation(p).Size());
+        AssertFitnessOwnTerminals(p);
+
+        // only the time spent breeding ahead can be hidden
+        auto [ breeding, hidden ] = p.GetBreedingStatistics();
+        ASSERT_GT(breeding, 0.0);
+        ASSERT_LE(hidden, breeding);
+
+        // families bred ahead have their own random numbers too, so pipelining is still deterministic
+        ASSERT_EQ(Individuals(p), RunSeeded(params));
+
+        // and a new run starts without any families bred ahead
+        p.Reset();
+        ASSERT_EQ(0, BredAhead(p));
+    }
+
+    TEST_F(PopulationTest, SteadyStateStoreReplace) 
+    {
+        std::vector<PopulationStore::ChromoPtr> chromosomes;
+        std::vector<double> terminals(1);
+        for (int i = 0; i < 2; ++i)
+        {
+            chromosomes.push_back(std::make_unique<Chromosome>(FunctionFactory::Create(&terminals[0], "a"), FitnessCases1, terminals, 0.0));
+        }
+        SteadyStateStore store(std::move(chromosomes));
+        const auto* original = store.Get(0);
+
+        // a slot is only replaced if it still holds the chromosome compared against
+        PopulationStore::ChromoPtr first = original->Clone();
+        PopulationStore::ChromoPtr second = original->Clone();
+        const auto* replacement = first.get();
+        ASSERT_TRUE(store.Replace(0, original, first));
+        ASSERT_EQ(nullptr, first);
+        ASSERT_FALSE(store.Replace(0, original, second));
+        ASSERT_NE(nullptr, second);
+        ASSERT_EQ(replacement, store.Get(0));
+
+        // the replaced chromosome is still readable until the store is released
+        ASSERT_DOUBLE_EQ(replacement->Fitness(), original->Fitness());
+        ASSERT_EQ(2u, store.Release().size());
+    }
+
     TEST_F(PopulationTest, PopulationAverageFitness) 
     {
         // test the method correctly returns the average
@@ -153,14 +612,171 @@ namespace Tests
 
     TEST_F(PopulationTest, PopulationSortPopulation) 
     {
-        // test the method correctly returns the best
-        // for 0, 1, more chromosomes
+        // the store orders IDs by weighted fitness and by fitness, without moving the chromosomes
+        std::vector<double> terminals(1);
+        auto chromosome = [&terminals](double fitness, double parsimony)
+        {
+            std::unique_ptr<INode> tree = FunctionFactory::Create(&terminals[0], "a");
+            return std::make_unique<Chromosome>(tree, fitness, parsimony);
+        };
+
+        PopulationStore store;
+        store.Add(chromosome(3.0, 0.0));
+        store.Add(chromosome(1.0, 5.0));
+        store.Add(chromosome(2.0, 0.0));
+        store.Sort();
+        ASSERT_EQ((std::vector<int>{ 1, 2, 0 }), store.ByFitness());
+        ASSERT_EQ((std::vector<int>{ 2, 0, 1 }), store.ByWeightedFitness());
+        ASSERT_DOUBLE_EQ(6.0, store.WeightedFitness()[1]);
+        ASSERT_DOUBLE_EQ(1.0, store[1].Fitness());
+
+        // replacing a chromosome updates its metadata
+        store.Replace(0, chromosome(0.5, 0.0));
+        store.Sort();
+        ASSERT_EQ((std::vector<int>{ 0, 1, 2 }), store.ByFitness());
+        ASSERT_EQ((std::vector<int>{ 0, 2, 1 }), store.ByWeightedFitness());
     }
 
     TEST_F(PopulationTest, PopulationGetNewOffspring) 
     {
         // Check that mutation and crossover occur when probability is = 1.0
         // and don't happen when probability is 0.0
+        auto params = Params2;
+        params.CrossoverProb = 0.0;
+        params.MutationProb = 0.0;
+        params.HoistMutationProb = 0.0;
+        Population p3{params, FitnessCases2};
+        p3.Reset();
+
+        // unmodified offspring keep their parents' fitness, reweighted for the new parsimony coefficient
+        const double parsimony = 0.5;
+        const auto& mum = AccessPopulation(p3)[0];
+        const auto& dad = AccessPopulation(p3)[1];
+        auto [son, daughter] = GetNewOffspring(p3, mum, dad, parsimony);
+        ASSERT_FALSE(son->IsModified());
+        ASSERT_FALSE(daughter->IsModified());
+        ASSERT_EQ(dad.ToString(), son->ToString());
+        ASSERT_DOUBLE_EQ(dad.Fitness(), son->Fitness());
+        ASSERT_DOUBLE_EQ(dad.Fitness() + parsimony*dad.Size(), son->WeightedFitness());
+        ASSERT_DOUBLE_EQ(mum.Fitness() + parsimony*mum.Size(), daughter->WeightedFitness());
+    }
+
+    TEST_F(PopulationTest, PopulationReproduce) 
+    {
+        // without crossover or mutation, every child is a copy of a parent, so the best two of the 
+        // family are both copies of the fitter parent
+        auto params = Params2;
+        params.CrossoverProb = 0.0;
+        params.MutationProb = 0.0;
+        params.HoistMutationProb = 0.0;
+        Population p3{params, FitnessCases2};
+        p3.Reset();
+
+        const auto& mum = AccessPopulation(p3)[0];
+        const auto& dad = AccessPopulation(p3)[1];
+        const auto& fitter = dad < mum ? dad : mum;
+        PopulationStore nextGeneration;
+        Reproduce(p3, mum, dad, nextGeneration);
+        ASSERT_EQ(2, nextGeneration.Size());
+        for (int id = 0; id < nextGeneration.Size(); ++id)
+        {
+            ASSERT_EQ(fitter.ToString(), nextGeneration[id].ToString());
+            ASSERT_DOUBLE_EQ(fitter.WeightedFitness(), nextGeneration[id].WeightedFitness());
+        }
+    }
+
+    TEST_F(PopulationTest, PopulationOperatorRates) 
+    {
+        // fixed probabilities never adapt
+        OperatorRates fixed(Params2);
+        fixed.Credit(GeneticOperator::Mutation, true);
+        fixed.Adapt();
+        ASSERT_DOUBLE_EQ(Params2.CrossoverProb, fixed.Probability(GeneticOperator::Crossover));
+        ASSERT_DOUBLE_EQ(Params2.MutationProb, fixed.Probability(GeneticOperator::Mutation));
+
+        // adaptive probabilities start within their bounds, then pursue the operator that improves most often
+        auto params = Params2;
+        params.AdaptiveOperators = true;
+        params.MinOperatorProb = 0.1;
+        params.MaxOperatorProb = 0.8;
+        params.OperatorAdaptationRate = 0.5;
+        OperatorRates adaptive(params);
+        ASSERT_DOUBLE_EQ(0.1, adaptive.Probability(GeneticOperator::Mutation));
+
+        for (int i = 0; i < 10; ++i)
+        {
+            adaptive.Credit(GeneticOperator::Crossover, i < 2);
+            adaptive.Credit(GeneticOperator::Mutation, i < 5);
+        }
+        adaptive.Adapt();
+        ASSERT_DOUBLE_EQ(0.7 + 0.5*(0.1 - 0.7), adaptive.Probability(GeneticOperator::Crossover));
+        ASSERT_DOUBLE_EQ(0.1 + 0.5*(0.8 - 0.1), adaptive.Probability(GeneticOperator::Mutation));
+        ASSERT_DOUBLE_EQ(0.1, adaptive.Probability(GeneticOperator::HoistMutation));
+
+        // mutation and hoist mutation are exclusive, so their probabilities never sum beyond 1
+        for (int i = 0; i < 10; ++i)
+        {
+            adaptive.Credit(GeneticOperator::HoistMutation, true);
+            adaptive.Adapt();
+        }
+        ASSERT_LE(adaptive.Probability(GeneticOperator::Mutation) + adaptive.Probability(GeneticOperator::HoistMutation), 1.0);
+        ASSERT_GT(adaptive.Probability(GeneticOperator::HoistMutation), adaptive.Probability(GeneticOperator::Mutation));
+    }
+
+    TEST_F(PopulationTest, PopulationGeometricSemantic) 
+    {
+        // offspring are evaluated from their semantics, yet agree with their reconstructed S-expressions,
+        // however many threads breed them
+        auto params = Params2;
+        params.Type = ChromosomeType::GeometricSemantic;
+        params.MutationProb = 0.5;
+        params.PopulationSize = 20;
+        params.Threads = 4;
+        Population gsgp{params, FitnessCases2};
+        gsgp.Reset();
+        for (int i = 0; i < 3; ++i)
+        {
+            gsgp.Evolve();
+        }
+
+        const auto& population = AccessPopulation(gsgp);
+        for (int i = 0; i < population.Size(); ++i)
+        {
+            const auto& individual = population[i];
+            ASSERT_EQ(individual.GetTree()->Size(), individual.Size());
+
+            Chromosome reference{ individual.GetTree()->Clone(), FitnessCases2, Terminals(gsgp), 0.0 };
+            ASSERT_NEAR(reference.Fitness(), individual.Fitness(), 1e-9 * std::max(1.0, reference.Fitness()));
+        }
+    }
+
+    TEST_F(PopulationTest, GenealogyCollection) 
+    {
+        // entries that no living individual descends from are removed, and the survivors still reconstruct
+        std::vector<double> terminals(2);
+        auto genealogy = std::make_shared<Genealogy>(Params2.AllowedFunctions,
+                std::vector<double*>{ &terminals[0], &terminals[1] }, FitnessCases2, terminals, 0.1);
+        auto tree = Chromosome::CreateRandomChromosome(Params2.MinInitialTreeSize, Params2.AllowedFunctions,
+                { &terminals[0], &terminals[1] });
+        SemanticChromosome parent{ genealogy, std::move(tree), terminals };
+        ASSERT_EQ(1, genealogy->Entries());
+        {
+            SemanticChromosome left{ parent }, right{ parent };
+            for (int i = 0; i < 10; ++i)
+            {
+                left.Crossover(right, TreeLimits{});
+                right.Mutate(MutationTable{});
+            }
+            ASSERT_LT(1, genealogy->Entries());
+            ASSERT_EQ(left.Size(), left.GetTree()->Size());
+        }
+        ASSERT_EQ(1, genealogy->Entries());
+
+        SemanticChromosome child{ parent };
+        child.Mutate(MutationTable{});
+        ASSERT_EQ(2, genealogy->Entries());
+        ASSERT_EQ(child.Size(), child.GetTree()->Size());
+        ASSERT_NE(std::string::npos, child.Summary().find(" of size " + std::to_string(child.Size())));
     }
 
     TEST_F(PopulationTest, PopulationParsimonyCoefficient) 
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include "../src/model/FunctionFactory.h"
+#include "../src/ConfigParser.h"
+#include "../src/Program.h"
+
+namespace
+{
+    Model::Config SweepConfig()
+    {
+        Model::Config config;
+        config.NumGenerations = 2;
+        config.Params.PopulationSize = 10;
+        config.Params.MinInitialTreeSize = 5;
+        config.Params.AllowedFunctions = { Model::FunctionType::Addition, Model::FunctionType::Multiplication };
+        config.Params.NumberOfTerminals = 2;
+        config.Params.Seed = 3;
+        config.Params.Threads = 2;
+        config.FitnessCases = 
+        {
+            3.0,  4.0,  5.0,
+            5.0,  12.0, 13.0,
+            8.0,  15.0, 17.0,
+            7.0,  24.0, 25.0,
+            20.0, 21.0, 29.0,
+            12.0, 35.0, 37.0
+        };
+        return config;
+    }
+}
+
+namespace Tests
+{
+    using namespace Model;
+
+    TEST(ProgramTest, SweepGrid) 
+    {
+        auto config = SweepConfig();
+        config.Sweep.Axes = 
+        {
+            { SweptParameter::PopulationSize, "PopulationSize", { 10, 20 } },
+            { SweptParameter::CarryOverProportion, "CarryOverProportion", { 0.0, 0.2, 0.4 } }
+        };
+
+        // every combination is run, varying the last axis fastest
+        Program program(config);
+        ASSERT_TRUE(program.IsSweep());
+        auto results = program.Sweep(false);
+        ASSERT_EQ(6u, results.size());
+        for (int i = 0; i < 6; ++i)
+        {
+            ASSERT_EQ(i < 3 ? 10 : 20, results[i].Params.PopulationSize);
+            ASSERT_DOUBLE_EQ(0.2 * (i % 3), results[i].Params.CarryOverProportion);
+            ASSERT_GE(results[i].Seconds, 0.0);
+            ASSERT_LT(results[i].BestFitness, std::numeric_limits<double>::max());
+        }
+
+        // predictions are made by the best configuration
+        auto best = std::min_element(results.begin(), results.end(), [](const auto& a, const auto& b)
+        {
+            return a.BestFitness < b.BestFitness;
+        });
+        auto fitted = config.FitnessCases;
+        ASSERT_EQ(best->BestFitness, program.Predict(fitted));
+
+        // with the same seed, configurations run the same way, whichever threads they run on
+        config.Params.Threads = 1;
+        auto again = Program(config).Sweep(false);
+        for (int i = 0; i < 6; ++i)
+        {
+            ASSERT_EQ(results[i].Params.Seed, again[i].Params.Seed);
+            ASSERT_EQ(results[i].BestFitness, again[i].BestFitness);
+        }
+    }
+
+    TEST(ProgramTest, SweepRandom) 
+    {
+        auto config = SweepConfig();
+        config.Sweep.Random = true;
+        config.Sweep.Samples = 4;
+        config.Sweep.Axes = 
+        {
+            { SweptParameter::TwinsPerMatingPair, "TwinsPerMatingPair", { 3, 1 } },
+            { SweptParameter::MutationProb, "MutationProb", { 0.1, 0.3 } }
+        };
+
+        // values are drawn between the least and greatest of each axis, and rounded if integers
+        auto results = Program(config).Sweep(false);
+        ASSERT_EQ(4u, results.size());
+        for (const auto& result : results)
+        {
+            ASSERT_GE(result.Params.TwinsPerMatingPair, 1);
+            ASSERT_LE(result.Params.TwinsPerMatingPair, 3);
+            ASSERT_GE(result.Params.MutationProb, 0.1);
+            ASSERT_LE(result.Params.MutationProb, 0.3);
+        }
+
+        // without any axes, there is no sweep
+        config.Sweep.Axes.clear();
+        Program program(config);
+        ASSERT_FALSE(program.IsSweep());
+        ASSERT_TRUE(program.Sweep(false).empty());
+
+        // so there's nothing to predict with
+        auto fitted = config.FitnessCases;
+        ASSERT_THROW(program.Predict(fitted), std::logic_error);
+
+        // nor is there without any iterations
+        config.Iterations = 0;
+        config.Sweep.Random = false;
+        config.Sweep.Axes = { { SweptParameter::MutationProb, "MutationProb", { 0.1, 0.3 } } };
+        Program unfitted(config);
+        ASSERT_EQ(2u, unfitted.Sweep(false).size());
+        ASSERT_THROW(unfitted.Predict(fitted), std::logic_error);
+    }
+
+    TEST(ProgramTest, ConcurrentPrograms) 
+    {
+        // programs of different data share nothing, so may run at the same time in one process
+        auto pythagoras = SweepConfig();
+        pythagoras.Sweep.Axes = { { SweptParameter::MutationProb, "MutationProb", { 0.1, 0.3 } } };
+        auto doubling = pythagoras;
+        doubling.Params.NumberOfTerminals = 1;
+        doubling.Params.Seed = 5;
+        doubling.FitnessCases = { 1.0, 2.0, 2.0, 4.0, 3.0, 6.0, 4.0, 8.0 };
+
+        std::vector<Program::SweepResult> first;
+        std::vector<Program::SweepResult> second;
+        std::thread thread([&]() { first = Program(pythagoras).Sweep(false); });
+        second = Program(doubling).Sweep(false);
+        thread.join();
+
+        // and run as they would alone
+        auto firstAlone = Program(pythagoras).Sweep(false);
+        auto secondAlone = Program(doubling).Sweep(false);
+        ASSERT_EQ(2u, first.size());
+        ASSERT_EQ(2u, second.size());
+        for (int i = 0; i < 2; ++i)
+        {
+            ASSERT_EQ(firstAlone[i].BestFitness, first[i].BestFitness);
+            ASSERT_EQ(secondAlone[i].BestFitness, second[i].BestFitness);
+        }
+    }
+
+    TEST(ProgramTest, InvalidSweepFails) 
+    {
+        // rather than running without the sweep (and with defaults for the rest of the config)
+        const std::string filename = "invalid_sweep.xml";
+        for (std::string parameter : { "<Parameter name=\"MutationProbability\">0.1 0.2</Parameter>",
+                "<Parameter name=\"MutationProb\"></Parameter>" })
+        {
+            {
+                std::ofstream config(filename);
+                config << "<Config><Generations>3</Generations><Sweep>" << parameter << "</Sweep></Config>";
+            }
+            ASSERT_THROW(ConfigParser::Load(filename), std::invalid_argument);
+        }
+        std::remove(filename.c_str());
+    }
+}
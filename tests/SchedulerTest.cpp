@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "../src/utils/Mailbox.h"
+#include "../src/utils/ThreadPool.h"
+#include "../src/utils/WorkStealingScheduler.h"
+
+namespace Tests
+{
+    class SchedulerTest : public ::testing::Test
+    {
+    protected:
+        SchedulerTest() { }
+
+        ~SchedulerTest() = default;
+    };
+
+    TEST_F(SchedulerTest, OneWorkerRunsLargestFirst) 
+    {
+        Util::WorkStealingScheduler scheduler(1);
+        std::vector<double> costs{ 1.0, 5.0, 3.0, 5.0, 2.0 };
+        std::vector<int> order;
+        scheduler.Run(costs, [&order](int task, int worker) 
+        { 
+            ASSERT_EQ(0, worker);
+            order.push_back(task); 
+        });
+
+        // ties keep their original order
+        ASSERT_EQ((std::vector<int>{ 1, 3, 2, 4, 0 }), order);
+        ASSERT_EQ(5, scheduler.Statistics()[0].Tasks);
+        ASSERT_EQ(0, scheduler.Statistics()[0].Stolen);
+    }
+
+    TEST_F(SchedulerTest, EveryTaskRunsOnce) 
+    {
+        // one large task, and many small ones that are stolen by the idle workers
+        const int numTasks = 200;
+        Util::WorkStealingScheduler scheduler(4);
+        std::vector<double> costs(numTasks, 1.0);
+        costs[0] = 100.0;
+
+        std::vector<std::atomic<int>> runs(numTasks);
+        for (int batch = 0; batch < 2; ++batch)
+        {
+            scheduler.Run(costs, [&runs](int task, int worker) 
+            { 
+                if (task == 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                }
+                ++runs[task]; 
+            });
+        }
+
+        long tasks = 0;
+        for (const auto& statistics : scheduler.Statistics())
+        {
+            tasks += statistics.Tasks;
+            ASSERT_LE(0.0, statistics.Utilisation());
+            ASSERT_GE(1.0, statistics.Utilisation());
+        }
+        ASSERT_EQ(2 * numTasks, tasks);
+        for (const auto& count : runs)
+        {
+            ASSERT_EQ(2, count);
+        }
+
+        scheduler.ResetStatistics();
+        ASSERT_EQ(0, scheduler.Statistics()[0].Tasks);
+    }
+
+    TEST_F(SchedulerTest, MailboxTakesEveryPost) 
+    {
+        // several threads post at once, while the items are taken
+        const int numThreads = 4;
+        const int numPosts = 1000;
+        Util::Mailbox<std::pair<int, int>> mailbox;
+        std::vector<std::pair<int, int>> taken;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; ++t)
+        {
+            threads.emplace_back([&mailbox, t]()
+            {
+                for (int i = 0; i < numPosts; ++i)
+                {
+                    mailbox.Post({ t, i });
+                }
+            });
+        }
+        for (int i = 0; i < 10; ++i)
+        {
+            auto items = mailbox.TakeAll();
+            taken.insert(taken.end(), items.begin(), items.end());
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        auto items = mailbox.TakeAll();
+        taken.insert(taken.end(), items.begin(), items.end());
+
+        // each thread's items are taken once, in the order it posted them
+        ASSERT_EQ(numThreads * numPosts, static_cast<int>(taken.size()));
+        std::vector<int> next(numThreads, 0);
+        for (auto [thread, i] : taken)
+        {
+            ASSERT_EQ(next[thread]++, i);
+        }
+        ASSERT_TRUE(mailbox.TakeAll().empty());
+    }
+
+    TEST_F(SchedulerTest, ThreadPoolRethrows) 
+    {
+        // every worker finishes the job before the exception of the lowest worker that threw is rethrown
+        Util::ThreadPool pool(4);
+        std::atomic<int> finished{ 0 };
+        auto job = [&finished](int worker)
+        {
+            if (worker == 0 || worker == 2)
+            {
+                throw std::runtime_error("worker " + std::to_string(worker));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            ++finished;
+        };
+        try
+        {
+            pool.Run(job);
+            FAIL();
+        }
+        catch (const std::runtime_error& e)
+        {
+            ASSERT_STREQ("worker 0", e.what());
+        }
+        ASSERT_EQ(2, finished);
+
+        // a worker thread's exception, and the pool is still usable afterwards
+        ASSERT_THROW(pool.Run([](int worker) { if (worker == 3) throw std::runtime_error("worker 3"); }), std::runtime_error);
+        finished = 0;
+        pool.Run([&finished](int worker) { ++finished; });
+        ASSERT_EQ(4, finished);
+    }
+}
@@ -4,6 +4,8 @@
 #include "OperatorsTest.cpp"
 #include "PopulationTest.cpp"
 #include "MathTest.cpp"
+#include "SchedulerTest.cpp"
+#include "ProgramTest.cpp"
 
 int main(int argc, char **argv)
 {